@@ -68,6 +68,185 @@
     contains the LSB that encodes if its a read or write access. So the SMB
 	address is shifted left by one bit.
 
+	The configuration registers of the PIC (WOT, delays, limits, brightness
+	source/multiplier/offset, initial display state and brightness, KEY_IN
+	control, auto brightness direction) are only changed by the driver. They
+	are read once at initialization and kept in a shadow copy which is
+	updated on every successful SetStat. GetStats of these values do not
+	access the SMBus.
+
+    \n \subsection downsig Shutdown event signal
+	#XC02_BLK_DOWN_SIG_SET installs a signal for the shutdown event, which
+	is polled periodically. In level mode (default) the signal is sent on
+	every poll while the event is pending. In edge mode
+	(#XC02_DOWN_SIG_EDGE) it is sent once when the event occurs and, if a
+	rearm interval is given, repeated after each interval while the event
+	is still pending. #XC02_DOWN_SIG_SUPPR counts the suppressed signals.
+
+	With minMsec/maxMsec set, the poll period adapts: while the firmware is
+	in SM_STATE_ON with KEY_IN on and no status flag set, the period is
+	doubled after every 4 idle polls up to maxMsec. On any activity it
+	drops to minMsec at once. #XC02_DOWN_SIG_PERIOD returns the current
+	period.
+
+    \n \subsection sampler Telemetry sampler
+	The driver can sample the temperature, voltage, binary inputs, backlight
+	current and raw photo sensor value periodically in the background. The
+	period is set with the SAMPLE_PERIOD descriptor key or #XC02_SMP_PERIOD,
+	the channels with SAMPLE_MASK or #XC02_SMP_MASK. Each sample is stored
+	as #XC02_SMP_REC record with a timestamp in a ring buffer of 64
+	records; when the buffer is full the oldest record is overwritten
+	(counted by #XC02_SMP_LOST). M_getblock() removes the oldest records
+	from the buffer and does not wait for new ones.
+
+	Each sample also updates running statistics (count, sum, min, max,
+	mean, exponentially weighted average and time of last change) of the
+	temperature, voltage, backlight current and photo sensor channels.
+	They are read with #XC02_BLK_STATS_GET; with the #XC02_STAT_RESET flag
+	set in the passed structure they are reset after reading.
+
+	On SC21 boards the sampler also integrates the backlight power over
+	time into a 64 bit energy counter [mWs] and records the peak power.
+	The backlight current channel must be sampled for this. Readings of
+	0xff (boards without backlight current measurement) are skipped.
+	#XC02_BLK_ENERGY_GET reads the counter, with the #XC02_ENERGY_RESET
+	flag set it is reset after reading.
+
+	All periodic driver work (sampler, threshold monitoring, input change
+	check, shutdown event poll, fades, brightness control, tracer and
+	watchdog heartbeat) is scheduled on one alarm. It is armed as one-shot
+	alarm for the next deadline; jobs falling due within 10ms (at least
+	one OS tick) of each other run in the same alarm call, and the alarm
+	stays off while no job is active. The jobs still access the board
+	controller register by register, their SMBus transfers are not
+	combined.
+
+    \n \subsection thresholds Warning thresholds
+	The PIC switches the display off (display protection) when the
+	temperature or voltage leaves the TEMP_LOW/HIGH or VOLT_LOW/HIGH window.
+	With #XC02_BLK_THRESH_SET the driver checks warning limits within this
+	window periodically and sends a signal whenever a limit is crossed or
+	the value is back by more than the hysteresis. The current state is
+	read with #XC02_THRESH_STATE, #XC02_THRESH_CLR stops the monitoring.
+
+    \n \subsection inputs Input change notification
+	Instead of polling #XC02_IN, #XC02_BLK_IN_SIG_SET lets the driver check
+	the inputs (KEY_IN, GA[3:0]) periodically and send a signal on every
+	change of the watched bits. Each change is also queued with a
+	timestamp (max. 16 entries); #XC02_BLK_IN_EVT_GET reads and removes
+	the queued transitions, so bursts of changes are not lost.
+
+    \n \subsection subscribers Event subscribers
+	The signals of #XC02_BLK_DOWN_SIG_SET, #XC02_BLK_THRESH_SET and
+	#XC02_BLK_IN_SIG_SET can only be installed once. Further processes
+	register with #XC02_BLK_SUBSCRIBE: each subscriber gets its own signal
+	for the events selected in its event mask (\ref XC02_EVT_xxx). Up to 8
+	subscribers are possible, identified by an id chosen by the caller,
+	which is passed to #XC02_UNSUBSCRIBE to remove the subscriber again.
+
+	Subscribing does not start any polling: events are only detected while
+	the shutdown event poll, threshold monitoring or input check is set up
+	with the setstats above. These accept signal 0 to set up the poll
+	without an own signal.
+
+    \n \subsection eventlog Event log
+	The driver records shutdown events, input changes, threshold state
+	changes, watchdog start/stop, SMBus errors and, if polled, firmware
+	state changes and missed watchdog triggers with a timestamp in a log
+	of 128 entries. The firmware state (XC02C_TEST4) and #XC02_WDOG_ERR are
+	polled with the period set by the LOG_PERIOD descriptor key or
+	#XC02_LOG_PERIOD.
+
+	Each entry has a sequence number. #XC02_BLK_LOG_GET returns up to 32
+	entries from the passed sequence number on and the cursor for the next
+	call, so a collector only fetches new entries. Reading does not remove
+	entries; entries overwritten before they were read are reported in
+	the lost field.
+
+    \n \subsection fade Brightness fades
+	#XC02_BLK_FADE_SET fades the brightness of screen 0 or 1 to a target
+	level within the given time. The driver writes a new level every 20ms
+	from its alarm, following a linear, ease (slow start and end) or square
+	curve. A new fade on the same screen starts from the current level, so
+	a running fade can be retargeted. #XC02_FADE_STOP or a direct
+	#XC02_BRIGHTNESS / #XC02_BRIGHTNESS2 setstat cancels it. Subscribers of
+	#XC02_EVT_FADE are signalled when a fade has reached its target,
+	#XC02_FADE_STATE shows the running fades.
+
+    \n \subsection brlut Logical brightness levels
+	The brightness registers take a PWM value 0..200 where 0 is brightest,
+	with very uneven perceived steps. #XC02_BR_LEVEL sets and gets a
+	logical level 0..255 of the display selected by the channel instead.
+	The level is mapped by a 256 entry lookup table, e.g. a gamma curve,
+	which is loaded once with #XC02_BLK_BR_LUT_SET (default: linear, 255
+	is brightest). Reading #XC02_BR_LEVEL does an inverse lookup. Fades
+	with the #XC02_FADE_LEVEL flag step through logical levels as well.
+
+    \n \subsection abr Auto brightness controller
+	As alternative to the firmware auto mode (#XC02_BR_SRC = 1), which
+	maps every change of the photo sensor linearly to the brightness,
+	#XC02_BLK_ABR_SET starts a controller in the driver. It samples
+	#XC02_RAW_BRIGHTNESS periodically, filters it with a median of the
+	last 5 samples and an exponentially weighted average, and maps the
+	result by a piecewise-linear ambient curve of up to 8 points to a
+	logical brightness level (see \ref brlut). The brightness registers
+	are only written when the level moved by more than the deadband, and
+	not while a fade is running on the screen. The brightness control
+	source should be set to host (#XC02_BR_SRC = 0). #XC02_ABR_AMBIENT
+	returns the filtered sensor value, #XC02_ABR_STOP stops the controller.
+
+    \n \subsection derate Thermal brightness derating
+	When the temperature exceeds TEMP_HIGH the PIC enters display
+	protection and switches the backlight off. #XC02_BLK_DERATE_SET lets
+	the driver poll the temperature and cap the brightness before that
+	happens: the derating curve (up to 4 points) gives the max. logical
+	brightness level for the distance of the temperature to TEMP_HIGH.
+	The cap is raised again only after the panel cooled down by more than
+	the hysteresis. Brightness set by the application, a fade or the auto
+	brightness controller is kept as setpoint and restored when the cap is
+	lifted or #XC02_DERATE_STOP is issued. While derating is active,
+	#XC02_BRIGHTNESS, #XC02_BRIGHTNESS2 and #XC02_BR_LEVEL report this
+	setpoint, so reading and writing back a value does not make the cap
+	permanent. #XC02_BR_EFFECTIVE returns the value actually written to the
+	PIC. #XC02_DERATE_CAP returns the current cap, each change is recorded
+	in the event log.
+
+    \n \subsection tracer Firmware state tracer
+	For debugging the shutdown sequence timing, #XC02_TRACE_PERIOD lets the
+	driver sample the firmware state (XC02C_TEST4, see XC02C_SM_STATES)
+	from its alarm (period min. 10ms). Only transitions are queued with a
+	timestamp (max. 32 entries); #XC02_BLK_TRACE_GET reads and removes
+	them. #XC02_BLK_TRACE_STATS_GET returns the number of stays and the
+	min/max/total dwell time per state, resolution is the sample period.
+
+    \n \subsection wdlease Watchdog heartbeat
+	With #XC02_WDOG_LEASE set to a lease time, the driver triggers the
+	started watchdog itself at a third of #WDOG_TIME. #WDOG_TRIG then only
+	renews the lease and causes no SMBus access. If the application fails
+	to renew it within the lease time, the driver stops triggering, logs
+	#XC02_LOG_WDOG_LAPSE and the watchdog expires as usual. Further
+	#WDOG_TRIG calls fail with ERR_LL_DEV_NOTRDY until #WDOG_START or
+	#XC02_WDOG_LEASE is issued again. #XC02_WDOG_LEASE_LEFT returns the
+	remaining lease time.
+
+	If several processes trigger the watchdog, #XC02_WDOG_COALESCE n lets
+	the driver skip a trigger when the last written one is younger than
+	#WDOG_TIME/n (n=4..100). The watchdog then expires at most this
+	interval earlier, so n=4 costs a quarter of the timeout as safety
+	margin. #XC02_BLK_WDOG_STATS_GET returns the number of issued, coalesced
+	and failed triggers.
+
+	To let the watchdog cover several processes, each registers with
+	#XC02_BLK_WDOG_REGISTER (own id, deadline, name) and then issues
+	#XC02_WDOG_CHECKIN with its id within its deadline. As with the lease,
+	the driver triggers the watchdog once per period as long as every
+	client is alive, so the SMBus load does not depend on the number of
+	clients. A plain #WDOG_TRIG is refused with ERR_LL_DEV_BUSY while
+	clients are registered and no lease is set. If a client misses its
+	deadline, #XC02_LOG_WDOG_STARVE is logged and
+	#XC02_BLK_WDOG_STARVED_GET names the client. #WDOG_START restarts all
+	deadlines, #XC02_WDOG_UNREGISTER removes a client.
+
     \n \subsection channels Logical channels
     The driver provides 4 logical channels from which currently only 2
 	are used, they represent the 2 possible displays that can be controlled
@@ -91,6 +270,8 @@
     <td>XC02_SetStat()</td></tr>
     <tr><td>M_getstat()   </td><td>Get device parameter     </td>
     <td>XC02_GetStat()</td></tr>
+    <tr><td>M_getblock()  </td><td>Read telemetry sampler records</td>
+    <td>XC02_BlockRead()</td></tr>
     <tr><td>M_errstringTs() </td><td>Generate error message </td>
     <td>-</td></tr>
     </table>
@@ -121,6 +302,28 @@
 		<td>required</td>
     </tr>
 
+    <tr><td>SMB_WORD_ACCESS</td>
+        <td>Use SMBus word transactions for 16 bit register pairs (WOT).
+			Only used if the firmware passes a read check at
+			initialization and the first word write reads back correctly,
+			otherwise the driver falls back to byte accesses.</td>
+        <td>0: byte accesses only\n
+			1: word accesses if supported\n
+			Default: 1</td>
+		<td>optional</td>
+    </tr>
+
+    <tr><td>SMB_BURST_READ</td>
+        <td>Read contiguous registers (e.g. for XC02_BLK_SNAPSHOT_GET) with
+			one combined I2C transfer. Only used if the SMBus controller
+			supports I2C transfers and the firmware passes a check at
+			initialization, otherwise registers are read bytewise.</td>
+        <td>0: byte reads only\n
+			1: burst reads if supported\n
+			Default: 1</td>
+		<td>optional</td>
+    </tr>
+
     <tr><td>WDOG_TOUT</td>
         <td>Watchdog timeout in 100ms units</td>
         <td>1..255 [100ms]\n
@@ -190,6 +393,24 @@
 		<td>Default: 100 (50%) Attention: 0=most bright, 200=most dark</td>
 		<td>optional</td>
     </tr>
+    <tr><td>SAMPLE_PERIOD</td>
+        <td>telemetry sampler period [ms]</td>
+        <td>0: sampler off, 10..n\n
+			Default: 0</td>
+		<td>optional</td>
+    </tr>
+    <tr><td>SAMPLE_MASK</td>
+        <td>sampled channels (XC02_SNAP_xxx flags)</td>
+        <td>see #XC02_SMP_MASK_ALL\n
+			Default: #XC02_SMP_MASK_ALL (0x187)</td>
+		<td>optional</td>
+    </tr>
+    <tr><td>LOG_PERIOD</td>
+        <td>event log poll period [ms]</td>
+        <td>0: off, 10..n\n
+			Default: 0</td>
+		<td>optional</td>
+    </tr>
     </table>
 
 	\attention changes made in the descriptors occur after next power cycle.
@@ -74,12 +74,210 @@
 	error = llHdl->smbH->ReadByteData(llHdl->smbH, 0, \
 		llHdl->smbAddr,(u_int8)(cmd),(u_int8*)(valP));
 
+#define SMB_W_WORD( cmd, val ) \
+	error = llHdl->smbH->WriteWordData( llHdl->smbH, 0, \
+		llHdl->smbAddr, (u_int8)(cmd), (u_int16)(val) );
+
+#define SMB_R_WORD( cmd, valP ) \
+	*valP = 0; \
+	error = llHdl->smbH->ReadWordData(llHdl->smbH, 0, \
+		llHdl->smbAddr,(u_int8)(cmd),(u_int16*)(valP));
+
 /* helper */
 #define NO_KEY 	ERR_DESC_KEY_NOTFOUND
 
+/* alarm jobs, scheduled on the shared one-shot alarm */
+#define JOB_DOWN		0		/**< shutdown event poll */
+#define JOB_SMP			1		/**< telemetry sampler */
+#define JOB_THRESH		2		/**< warning threshold check */
+#define JOB_IN			3		/**< input change check */
+#define JOB_LOG			4		/**< event log poll */
+#define JOB_FADE		5		/**< brightness fade steps */
+#define JOB_ABR			6		/**< auto brightness controller */
+#define JOB_DERATE		7		/**< thermal brightness derating */
+#define JOB_TRACE		8		/**< firmware state tracer */
+#define JOB_WDOG		9		/**< watchdog heartbeat */
+#define JOB_NUM			10		/**< number of alarm jobs */
+#define ALM_MERGE_MSEC	10		/**< jobs due within this run together */
+
+/* shutdown event signal */
+#define DOWN_SIG_SIZE_V1 (2*sizeof(u_int32))	/**< XC02_BLK_DOWN_SIG w/o mode */
+#define DOWN_SIG_SIZE_V2 (4*sizeof(u_int32))	/**< ... w/o min/maxMsec */
+#define DOWN_RELAX_POLLS	4	/**< adaptive: idle polls before doubling */
+
+/* telemetry sampler */
+#define SMP_RING_SIZE	64		/**< sampler records (power of 2) */
+#define SMP_PERIOD_MIN	10		/**< min. sampler period [ms] */
+
+/* telemetry statistics */
+#define STAT_CH_NUM		4		/**< = XC02_STAT_CH_NUM */
+#define STAT_EWMA_SHIFT	4		/**< EWMA alpha = 1/16 */
+
+/* backlight energy */
+#define ENERGY_DT_MAX	3600000	/**< max. integrated sample gap [ms] */
+
+/* input change queue */
+#define IN_EVT_NUM		16		/**< = XC02_IN_EVT_MAX (power of 2) */
+
+/* event log */
+#define LOG_NUM			128		/**< log entries (power of 2) */
+#define LOG_PERIOD_MIN	10		/**< min. log poll period [ms] */
+
+/* brightness fade engine */
+#define FADE_NUM		2		/**< screens (XC02C_SET_BR, XC02C_SET_BR_2) */
+#define FADE_PERIOD		20		/**< fade step period [ms] */
+#define FADE_MSEC_MAX	60000	/**< max. fade duration [ms] */
+#define BR_MAX			200		/**< max. brightness level */
+#define BR_LUT_SIZE		256		/**< = XC02_BR_LUT_SIZE */
+
+/* auto brightness controller */
+#define ABR_PTS			8		/**< = XC02_ABR_PTS_MAX */
+#define ABR_PERIOD_MIN	10		/**< min. sample period [ms] */
+#define ABR_MEDIAN		5		/**< median filter window */
+#define ABR_EWMA_SHIFT	2		/**< EWMA alpha = 1/4 */
+
+/* thermal derating */
+#define DER_PTS			4		/**< = XC02_DERATE_PTS_MAX */
+#define DER_PERIOD_MIN	100		/**< min. poll period [ms] */
+
+/* firmware state tracer */
+#define TRC_EVT_NUM		32		/**< = XC02_TRACE_MAX (power of 2) */
+#define TRC_ST_NUM		8		/**< = XC02_TRACE_STATES */
+#define TRC_PERIOD_MIN	10		/**< min. sample period [ms] */
+
+/* watchdog heartbeat */
+#define WD_LEASE_MIN	100		/**< min. lease [ms] */
+#define WD_COAL_MIN		4		/**< min. coalescing divider */
+#define WD_COAL_MAX		100		/**< max. coalescing divider */
+#define WD_CLI_NUM		8		/**< = XC02_WDOG_CLIENT_MAX */
+#define WD_NAME_LEN		16		/**< = XC02_WDOG_NAME_LEN */
+
+/* event subscribers: legacy signal slots, then XC02_SUBSCR_MAX user slots */
+#define SUBSCR_DOWN		0		/**< XC02_BLK_DOWN_SIG_SET signal */
+#define SUBSCR_THRESH	1		/**< XC02_BLK_THRESH_SET signal */
+#define SUBSCR_IN		2		/**< XC02_BLK_IN_SIG_SET signal */
+#define SUBSCR_USER		3		/**< first XC02_BLK_SUBSCRIBE slot */
+#define SUBSCR_NUM		(SUBSCR_USER+8)	/**< 8 = XC02_SUBSCR_MAX */
+
+/* burst read */
+#define BURST_MAX		32		/**< max. bytes per burst transfer */
+#define BURST_GAP		8		/**< max. unused registers read in between */
+#define BURST_PROBE_REG	XC02C_DOWN_DELAY	/**< probe XC02C_DOWN_DELAY..IN */
+
+/* register shadow */
+#define SHADOW_SIZE		0x40	/**< shadowed PIC cmd range 0x00..0x3f */
+#define SHADOW_CFG		0x01	/**< register is a cached config register */
+#define SHADOW_VALID	0x02	/**< shadow value is valid */
+
+/* register descriptor access modes */
+#define ACC_R			0x01	/**< readable by getstat */
+#define ACC_W			0x02	/**< writable by setstat */
+#define ACC_RW			(ACC_R|ACC_W)
+
+/* register descriptor conversions */
+#define CONV_NONE		0		/**< raw register value */
+#define CONV_TEMP		1		/**< value in degree C, register ADC value */
+#define CONV_WORD		2		/**< 16 bit value in register pair cmd/cmd+1 */
+#define CONV_CHAN		3		/**< register cmd+ch, channel selects display */
+#define CONV_FLAG		4		/**< write XC02C_FLAG, value ignored */
+
+/* register descriptor volatility classes */
+#define VOL_CFG			0		/**< config, only changed by driver (shadowed) */
+#define VOL_DYN			1		/**< writable, but also changed by firmware */
+#define VOL_TELEM		2		/**< read only telemetry or status */
+#define VOL_CMD			3		/**< write only command */
+
+/* setstat range for codes which accept any value */
+#define ANY_MIN			(-0x7fffffff-1)
+#define ANY_MAX			0x7fffffff
+
+/* byte offset of a field in XC02_SMP_REC */
+#define SMP_OFFS( field ) \
+	((u_int8)((u_int8*)&((XC02_SMP_REC*)0)->field - (u_int8*)0))
+
+/* byte offset of a field in XC02_BLK_SNAPSHOT */
+#define SNAP_OFFS( field ) \
+	((u_int8)((u_int8*)&((XC02_BLK_SNAPSHOT*)0)->field - (u_int8*)0))
+
 /*-----------------------------------------+
 |  TYPEDEFS                                |
 +-----------------------------------------*/
+/** periodic job of the shared alarm */
+typedef struct {
+	u_int32					msec;		/**< period [ms], 0: inactive */
+	u_int32					curMsec;	/**< current period [ms], >= msec */
+	u_int32					next;		/**< next due time [ticks] */
+} ALM_JOB;
+
+/** statistics of one telemetry channel (see XC02_STAT_CH) */
+typedef struct {
+	u_int32					count;		/**< number of samples */
+	u_int32					sum;		/**< sum of samples */
+	u_int32					mean;		/**< mean [ADC * 256] */
+	u_int32					ewma;		/**< EWMA [ADC * 256] */
+	u_int32					lastChange;	/**< time of last change [ticks] */
+	u_int8					min;		/**< minimum value */
+	u_int8					max;		/**< maximum value */
+	u_int8					last;		/**< last value */
+} STAT_CH;
+
+/** input transition (see XC02_IN_EVT) */
+typedef struct {
+	u_int32					tick;		/**< time of detection [ticks] */
+	u_int8					oldVal;		/**< previous XC02C_IN value */
+	u_int8					newVal;		/**< new XC02C_IN value */
+} IN_EVT;
+
+/** firmware state transition (see XC02_TRACE_EVT) */
+typedef struct {
+	u_int32					tick;		/**< time of detection [ticks] */
+	u_int8					from;		/**< previous state */
+	u_int8					to;			/**< new state */
+} TRC_EVT;
+
+/** dwell time statistics of one firmware state (see XC02_TRACE_DWELL) */
+typedef struct {
+	u_int32					count;		/**< completed stays */
+	u_int32					minMsec;	/**< shortest stay [ms] */
+	u_int32					maxMsec;	/**< longest stay [ms] */
+	u_int32					sumMsec;	/**< sum of stays [ms] */
+} TRC_ST;
+
+/** watchdog client (see XC02_BLK_WDOG_CLIENT) */
+typedef struct {
+	u_int32					id;			/**< client id, 0: slot unused */
+	u_int32					deadline;	/**< max. check-in interval [ms] */
+	u_int32					end;		/**< deadline expiry [ticks] */
+	char					name[WD_NAME_LEN];	/**< client name */
+} WD_CLI;
+
+/** event log entry (see XC02_LOG_ENTRY) */
+typedef struct {
+	u_int32					tick;		/**< time of event [ticks] */
+	u_int32					data;		/**< event data */
+	u_int8					type;		/**< XC02_LOG_xxx */
+} LOG_ENT;
+
+/** brightness fade of one screen */
+typedef struct {
+	u_int32					active;		/**< fade running */
+	u_int32					gen;		/**< incremented on retarget/cancel */
+	u_int32					start;		/**< start time [ticks] */
+	u_int32					ticks;		/**< duration [ticks] */
+	u_int8					curve;		/**< XC02_FADE_xxx */
+	u_int8					from;		/**< start level */
+	u_int8					to;			/**< target level */
+	u_int8					last;		/**< last written level */
+	u_int8					lvl;		/**< levels are logical (brLut) */
+} FADE;
+
+/** event subscriber */
+typedef struct {
+	u_int32					id;			/**< subscriber id */
+	u_int32					evtMask;	/**< XC02_EVT_xxx, 0: slot free */
+	OSS_SIG_HANDLE			*sig;		/**< signal handle or NULL */
+} SUBSCR;
+
 /** low-level handle */
 typedef struct {
 	/* general */
@@ -95,9 +293,131 @@ typedef struct {
 	/* FW(PIC) specific */
 	SMB_HANDLE				*smbH;		/**< ptr to SMB_HANDLE struct */
 	u_int16					smbAddr;	/**< SMB address of XC02 */
-    OSS_SIG_HANDLE  		*sigHdl;    /**< signal handle */
     OSS_ALARM_HANDLE 		*alarmHdl;	/**< alarm handle */
 	u_int8					wdState;	/**< Watchdog state */
+	u_int8					wordAcc;	/**< SMBus word access usable */
+	u_int8					wordWrOk;	/**< word write verified */
+	u_int8					burstAcc;	/**< I2C burst read usable */
+	u_int8					burstOk[SHADOW_SIZE];	/**< register may be\n
+											 read by a burst */
+	/* shutdown event signal */
+	u_int32					downMode;	/**< XC02_DOWN_SIG_LEVEL/EDGE */
+	u_int32					downRearm;	/**< resend interval [ms], 0: never */
+	u_int32					downPend;	/**< event was set at last poll */
+	u_int32					downSigTick;	/**< time of last signal [ticks] */
+	u_int32					downSuppr;	/**< suppressed signals */
+	u_int32					downMaxMsec;	/**< adaptive: idle period [ms] */
+	u_int32					downQuiet;	/**< adaptive: idle polls */
+	/* shared alarm */
+	u_int32					tickRate;	/**< OSS ticks per second */
+	u_int32					almArmed;	/**< alarm is armed (under smpLock) */
+	u_int32					almDue;		/**< expected expiry [ticks] */
+	u_int32					almMerge;	/**< merge window [ticks] */
+	u_int32					almBusy;	/**< AlarmUpdate() running */
+	u_int32					almPend;	/**< AlarmUpdate() to be redone */
+	ALM_JOB					job[JOB_NUM];	/**< jobs run by the alarm\n
+												 (under smpLock) */
+	u_int32					almRun;		/**< job running, JOB_NUM: none */
+	/* telemetry sampler */
+	u_int32					smpMask;	/**< sampled XC02_SNAP_xxx flags */
+	OSS_SPINL_HANDLE		*smpLock;	/**< protects data filled by alarm */
+	struct XC02_SMP_REC_S	*smpRing;	/**< sampler records */
+	u_int32					smpRingAlloc; /**< size allocated for ring */
+	u_int32					smpIn;		/**< next ring index to write */
+	u_int32					smpCnt;		/**< records in ring */
+	u_int32					smpLost;	/**< overwritten records */
+	STAT_CH					stat[STAT_CH_NUM];	/**< statistics */
+	u_int32					enLo;		/**< energy [mWs], low 32 bit */
+	u_int32					enHi;		/**< energy [mWs], high 32 bit */
+	u_int32					enRem;		/**< energy remainder [mW * ms] */
+	u_int32					enPeak;		/**< peak power [mW] */
+	u_int32					enPrevMw;	/**< power of prev. sample [mW] */
+	u_int32					enPrevTick;	/**< time of prev. sample [ticks] */
+	u_int32					enPrevVld;	/**< enPrevMw/Tick valid */
+	u_int32					enSince;	/**< time of last reset [ticks] */
+	/* warning thresholds */
+	u_int32					thrMask;	/**< checked XC02_THR_TEMP/VOLT */
+	int32					thrTempHigh;	/**< temp high limit [C] */
+	int32					thrTempLow;		/**< temp low limit [C] */
+	int32					thrTempHyst;	/**< temp hysteresis [C] */
+	int32					thrVoltHigh;	/**< volt high limit [mV] */
+	int32					thrVoltLow;		/**< volt low limit [mV] */
+	int32					thrVoltHyst;	/**< volt hysteresis [mV] */
+	u_int32					thrState;	/**< XC02_THR_xxx state flags */
+	/* input change notification */
+	u_int8					inMask;		/**< watched XC02C_IN bits */
+	u_int8					inLast;		/**< last XC02C_IN value */
+	IN_EVT					inEvt[IN_EVT_NUM];	/**< transition queue */
+	u_int32					inEvtIn;	/**< next queue index to write */
+	u_int32					inEvtCnt;	/**< transitions in queue */
+	u_int32					inEvtLost;	/**< lost transitions */
+	/* event subscribers (filled under smpLock) */
+	SUBSCR					subscr[SUBSCR_NUM];	/**< SUBSCR_xxx slots */
+	/* event log (filled under smpLock) */
+	LOG_ENT					log[LOG_NUM];	/**< log ring */
+	u_int32					logSeq;		/**< sequence nr. of next entry */
+	u_int8					logSmbErr;	/**< last SMBus access failed */
+	u_int8					logPolled;	/**< logFwState/logWdErr valid */
+	u_int8					logFwState;	/**< last XC02C_TEST4 value */
+	u_int8					logWdErr;	/**< last XC02C_WDOG_ERR value */
+	/* brightness fade engine (filled under smpLock) */
+	FADE					fade[FADE_NUM];	/**< fade per screen */
+	u_int8					brLut[BR_LUT_SIZE];	/**< level to PWM */
+	/* auto brightness controller (curve filled under smpLock) */
+	u_int32					abrNum;		/**< points of ambient curve */
+	u_int8					abrRaw[ABR_PTS];	/**< curve: ambient values */
+	u_int8					abrLvl[ABR_PTS];	/**< curve: logical levels */
+	u_int32					abrScreens;	/**< controlled screens */
+	u_int32					abrDeadband; /**< min. level change */
+	int32					abrOut;		/**< last written level, -1: none */
+	u_int8					abrWin[ABR_MEDIAN];	/**< median window */
+	u_int32					abrWinIdx;	/**< next window index */
+	u_int32					abrWinCnt;	/**< window primed */
+	u_int32					abrEwma;	/**< filtered ambient [ADC * 256] */
+	/* brightness setpoints */
+	u_int8					brUser[FADE_NUM];	/**< requested values */
+	u_int32					brUserVld;	/**< brUser valid, bit per screen */
+	/* thermal derating */
+	u_int32					derScreens;	/**< derated screens, 0: off */
+	u_int32					derNum;		/**< points of derating curve */
+	u_int8					derDelta[DER_PTS];	/**< curve: dist. to limit */
+	u_int8					derLvl[DER_PTS];	/**< curve: max. levels */
+	u_int32					derHyst;	/**< hysteresis [C] */
+	int32					derTemp;	/**< temp for curve [C] */
+	u_int32					derTempVld;	/**< derTemp valid */
+	u_int32					derCapLvl;	/**< current cap (logical level) */
+	u_int8					derCapPwm;	/**< current cap (PWM), 0: none */
+	/* firmware state tracer (filled under smpLock) */
+	u_int32					trcVld;		/**< trcState/trcEnter valid */
+	u_int8					trcState;	/**< current state */
+	u_int32					trcEnter;	/**< time state was entered [ticks] */
+	TRC_EVT					trcEvt[TRC_EVT_NUM];	/**< transition queue */
+	u_int32					trcIn;		/**< next queue index to write */
+	u_int32					trcCnt;		/**< transitions in queue */
+	u_int32					trcLost;	/**< lost transitions */
+	TRC_ST					trcSt[TRC_ST_NUM];	/**< dwell statistics */
+	/* watchdog heartbeat/clients (wdLeaseEnd/wdLapsed under smpLock) */
+	u_int32					wdLease;	/**< lease [ms], 0: off */
+	u_int32					wdLeaseEnd;	/**< lease expiry [ticks] */
+	u_int32					wdLapsed;	/**< lease lapsed */
+	/* watchdog trigger coalescing (counters/wdTrigTick under smpLock) */
+	u_int32					wdCoal;		/**< divider of WDOG_TIME, 0: off */
+	u_int32					wdTrigVld;	/**< wdTrigTick valid */
+	u_int32					wdTrigTick;	/**< last issued trigger [ticks] */
+	u_int32					wdIssued;	/**< triggers written */
+	u_int32					wdCoalesced;	/**< triggers suppressed */
+	u_int32					wdFailed;	/**< trigger writes failed */
+	/* watchdog clients (under smpLock) */
+	WD_CLI					wdCli[WD_CLI_NUM];	/**< registered clients */
+	u_int32					wdCliNum;	/**< number of clients */
+	WD_CLI					wdStarved;	/**< culprit of last lapse,\n
+											 end: time of detection */
+	/* shadow of VOL_CFG PIC registers, indexed by PIC cmd */
+	u_int8					shadow[SHADOW_SIZE];	 /**< register values */
+	u_int8					shadowFlg[SHADOW_SIZE]; /**< SHADOW_xxx flags */
+	/* result of last XC02_BLK_BATCH_SET */
+	u_int32					batchApplied;	/**< nr. of applied entries */
+	int32					batchFailIdx;	/**< first failing entry or -1 */
 } LL_HANDLE;
 
 /* include files which need LL_HANDLE */
@@ -106,6 +426,90 @@ typedef struct {
 
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
+/** register descriptor of an XC02 getstat/setstat code */
+typedef struct {
+	const char	*name;		/**< code name (debug) */
+	u_int8		cmd;		/**< PIC register (low byte / display 0) */
+	u_int8		acc;		/**< ACC_xxx access mode */
+	u_int8		conv;		/**< CONV_xxx conversion */
+	u_int8		vol;		/**< VOL_xxx volatility class */
+	u_int16		mask;		/**< value mask */
+	u_int16		snap;		/**< XC02_SNAP_xxx flag, 0: not in snapshot */
+	int32		min;		/**< min. setstat value */
+	int32		max;		/**< max. setstat value */
+	u_int8		snapOffs;	/**< offset in XC02_BLK_SNAPSHOT */
+} REG_DESC;
+
+/** Register descriptors of the XC02 codes, indexed by (code - M_DEV_OF).
+ *  Codes with access 0 are handled directly by XC02_SetStat/GetStat. */
+static const REG_DESC G_RegDesc[] = {
+/*	  name					 PIC register		access	conversion	volatility mask    snapshot flag		 min			 max					   snapshot field */
+/*00*/{ NULL,				 0,					0,		CONV_NONE,	VOL_CMD,   0,	   0,					 0,				 0,						   0 },
+/*01*/{ "XC02_WOT",			 XC02C_WOT_L,		ACC_RW,	CONV_WORD,	VOL_CFG,   0xffff, 0,					 0,				 0xffff,				   0 },
+/*02*/{ "XC02_WDOG_ERR",	 XC02C_WDOG_ERR,	ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   0,					 0,				 0,						   0 },
+/*03*/{ "XC02_SWOFF",		 XC02C_SWOFF,		ACC_W,	CONV_NONE,	VOL_CMD,   0xff,   0,					 ANY_MIN,		 ANY_MAX,				   0 },
+/*04*/{ "XC02_OFFACK",		 XC02C_OFFACK,		ACC_W,	CONV_FLAG,	VOL_CMD,   0xff,   0,					 ANY_MIN,		 ANY_MAX,				   0 },
+/*05*/{ "XC02_DOWN_DELAY",	 XC02C_DOWN_DELAY,	ACC_RW,	CONV_NONE,	VOL_CFG,   0xff,   0,					 XC02C_DOWN_DELAY_MINMODE, XC02C_DOWN_DELAY_MAXMODE, 0 },
+/*06*/{ "XC02_OFF_DELAY",	 XC02C_OFF_DELAY,	ACC_RW,	CONV_NONE,	VOL_CFG,   0xff,   0,					 XC02C_OD_MINMODE, XC02C_OD_MAXMODE,	   0 },
+/*07*/{ "XC02_DOWN_EVT",	 XC02C_STATUS,		ACC_R,	CONV_NONE,	VOL_TELEM, 0x03,   XC02_SNAP_STATUS,	 0,				 0,						   SNAP_OFFS(status) },
+/*08*/{ NULL,				 0,					0,		CONV_NONE,	VOL_CMD,   0,	   0,					 0,				 0,						   0 },
+/*09*/{ "XC02_IN",			 XC02C_IN,			ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   XC02_SNAP_IN,		 0,				 0,						   SNAP_OFFS(in) },
+/*0a*/{ "XC02_TEMP",		 XC02C_TEMP,		ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   XC02_SNAP_TEMP,		 0,				 0,						   SNAP_OFFS(temp) },
+/*0b*/{ "XC02_TEMP_HIGH",	 XC02C_TEMP_HIGH,	ACC_RW,	CONV_TEMP,	VOL_CFG,   0xff,   0,					 TEMP_RANGE_MIN, TEMP_RANGE_MAX,		   0 },
+/*0c*/{ "XC02_TEMP_LOW",	 XC02C_TEMP_LOW,	ACC_RW,	CONV_TEMP,	VOL_CFG,   0xff,   0,					 TEMP_RANGE_MIN, TEMP_RANGE_MAX,		   0 },
+/*0d*/{ "XC02_BRIGHTNESS",	 XC02C_SET_BR,		ACC_RW,	CONV_NONE,	VOL_DYN,   0xff,   XC02_SNAP_BRIGHT,	 ANY_MIN,		 ANY_MAX,				   SNAP_OFFS(bright) },
+/*0e*/{ "XC02_BR_SRC",		 XC02C_BR_SRC,		ACC_RW,	CONV_NONE,	VOL_CFG,   0xff,   0,					 0,				 1,						   0 },
+/*0f*/{ "XC02_SW_DISP",		 XC02C_SW_DISP,		ACC_RW,	CONV_NONE,	VOL_DYN,   0xff,   XC02_SNAP_SW_DISP,	 0,				 3,						   SNAP_OFFS(swDisp) },
+/*10*/{ "XC02_DISP_INITSTAT", XC02C_INIT_DS,	ACC_RW,	CONV_NONE,	VOL_CFG,   0xff,   0,					 0,				 3,						   0 },
+/*11*/{ "XC02_TIMESTAMP",	 XC02C_TIMESTAMP,	ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   0,					 0,				 0,						   0 },
+/*12*/{ "XC02_VOLTAGE",		 XC02C_VOLT,		ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   XC02_SNAP_VOLT,		 0,				 0,						   SNAP_OFFS(volt) },
+/*13*/{ "XC02_VOLT_LOW",	 XC02C_VOLT_LOW,	ACC_R,	CONV_NONE,	VOL_CFG,   0xff,   0,					 0,				 0,						   0 },
+/*14*/{ "XC02_VOLT_HIGH",	 XC02C_VOLT_HIGH,	ACC_R,	CONV_NONE,	VOL_CFG,   0xff,   0,					 0,				 0,						   0 },
+/*15*/{ "XC02_TEST1",		 XC02C_TEST1,		ACC_RW,	CONV_NONE,	VOL_DYN,   0xff,   0,					 ANY_MIN,		 ANY_MAX,				   0 },
+/*16*/{ "XC02_TEST2",		 XC02C_TEST2,		ACC_RW,	CONV_NONE,	VOL_DYN,   0xff,   0,					 ANY_MIN,		 ANY_MAX,				   0 },
+/*17*/{ "XC02_TEST3",		 XC02C_TEST3,		ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   0,					 0,				 0,						   0 },
+/*18*/{ "XC02_TEST4",		 XC02C_TEST4,		ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   0,					 0,				 0,						   0 },
+/*19*/{ "XC02_INIT_BRIGHT",	 XC02C_INIT_BR1,	ACC_RW,	CONV_CHAN,	VOL_CFG,   0xff,   0,					 ANY_MIN,		 ANY_MAX,				   0 },
+/*1a*/{ "XC02_BRIGHTNESS2",	 XC02C_SET_BR_2,	ACC_RW,	CONV_NONE,	VOL_DYN,   0xff,   XC02_SNAP_BRIGHT2,	 ANY_MIN,		 ANY_MAX,				   SNAP_OFFS(bright2) },
+/*1b*/{ "XC02_MINICARD_PWR", XC02C_SW_MINICARD,	ACC_RW,	CONV_NONE,	VOL_CFG,   0xff,   0,					 ANY_MIN,		 ANY_MAX,				   0 },
+/*1c*/{ "XC02_BR_OFFS",		 XC02C_AUTO_BR_OFFS,ACC_RW,	CONV_NONE,	VOL_CFG,   0xff,   0,					 0,				 0xfe,					   0 },
+/*1d*/{ "XC02_BR_MULT",		 XC02C_AUTO_BR_FAK,	ACC_RW,	CONV_NONE,	VOL_CFG,   0xff,   0,					 0,				 100,					   0 },
+/*1e*/{ "SC21_BL_CURRENT",	 SC21C_BL_CURR,		ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   XC02_SNAP_BL_CURR,	 0,				 0,						   SNAP_OFFS(blCurr) },
+/*1f*/{ "XC02_BRIGHT_DIRECTION", SC21C_BR_DIR,	ACC_RW,	CONV_NONE,	VOL_CFG,   0xff,   0,					 0,				 1,						   0 },
+/*20*/{ "XC02_RAW_BRIGHTNESS", SC21C_BR_RAW,	ACC_R,	CONV_NONE,	VOL_TELEM, 0xff,   XC02_SNAP_BR_RAW,	 0,				 0,						   SNAP_OFFS(brRaw) },
+/*21*/{ "XC02_KEY_IN_CTRL",	 SC21C_KEY_CTRL,	ACC_RW,	CONV_NONE,	VOL_CFG,   0x01,   0,					 ANY_MIN,		 ANY_MAX,				   0 },
+/*22*/{ "XC02_AUTO_BRIGHT_CTRL", SC21C_BR_DIR,	ACC_RW,	CONV_NONE,	VOL_CFG,   0x01,   0,					 ANY_MIN,		 ANY_MAX,				   0 }
+};
+
+#define REG_DESC_NUM	(sizeof(G_RegDesc)/sizeof(REG_DESC))
+
+/** telemetry sampler channels */
+static const struct {
+	u_int16		flag;		/**< XC02_SNAP_xxx flag */
+	u_int8		cmd;		/**< PIC register */
+	u_int8		offs;		/**< offset in XC02_SMP_REC */
+} G_SmpChan[] = {
+	{ XC02_SNAP_TEMP,	 XC02C_TEMP,	SMP_OFFS(temp)	 },
+	{ XC02_SNAP_VOLT,	 XC02C_VOLT,	SMP_OFFS(volt)	 },
+	{ XC02_SNAP_IN,		 XC02C_IN,		SMP_OFFS(in)	 },
+	{ XC02_SNAP_BL_CURR, SC21C_BL_CURR,	SMP_OFFS(blCurr) },
+	{ XC02_SNAP_BR_RAW,	 SC21C_BR_RAW,	SMP_OFFS(brRaw)	 }
+};
+
+/** statistics channels, indexed by XC02_STAT_xxx */
+static const struct {
+	u_int16		flag;		/**< XC02_SNAP_xxx flag */
+	u_int8		offs;		/**< offset in XC02_SMP_REC */
+} G_StatChan[XC02_STAT_CH_NUM] = {
+	{ XC02_SNAP_TEMP,	 SMP_OFFS(temp)	  },
+	{ XC02_SNAP_VOLT,	 SMP_OFFS(volt)	  },
+	{ XC02_SNAP_BL_CURR, SMP_OFFS(blCurr) },
+	{ XC02_SNAP_BR_RAW,	 SMP_OFFS(brRaw)  }
+};
+
+/** brightness register of each fade screen */
+static const u_int8 G_FadeReg[FADE_NUM] = { XC02C_SET_BR, XC02C_SET_BR_2 };
+
 /*-----------------------------------------+
 |  PROTOTYPES                              |
 +-----------------------------------------*/
@@ -129,6 +533,93 @@ static int32 Cleanup(LL_HANDLE *llHdl, int32 retCode);
 
 /* XC02 specific helper functions */
 static void AlarmHandler(void *arg);
+static void ShadowInit(LL_HANDLE *llHdl);
+static int32 RegRead(LL_HANDLE *llHdl, u_int8 cmd, u_int8 *valP);
+static int32 RegWrite(LL_HANDLE *llHdl, u_int8 cmd, u_int8 val);
+static int32 Reg16Read(LL_HANDLE *llHdl, u_int8 cmd, u_int16 *valP);
+static int32 Reg16Write(LL_HANDLE *llHdl, u_int8 cmd, u_int16 val);
+static void WordAccProbe(LL_HANDLE *llHdl);
+static int32 RegBurstRead(LL_HANDLE *llHdl, u_int8 cmd, u_int8 *buf,
+						  u_int32 num);
+static void BurstProbe(LL_HANDLE *llHdl);
+static void BurstMaskInit(LL_HANDLE *llHdl);
+static int32 SnapshotGet(LL_HANDLE *llHdl, XC02_BLK_SNAPSHOT *snap);
+static int32 ConfigGet(LL_HANDLE *llHdl, XC02_BLK_CONFIG *cfg);
+static int32 RegSetCheck(int32 code, int32 ch, int32 value);
+static int32 RegSet(LL_HANDLE *llHdl, int32 code, int32 ch, int32 value);
+static const REG_DESC* RegDescGet(int32 code);
+static int32 RegDescGetStat(LL_HANDLE *llHdl, const REG_DESC *d, int32 ch,
+							int32 *valueP);
+static int32 RegDescSetStat(LL_HANDLE *llHdl, const REG_DESC *d, int32 ch,
+							int32 value);
+static int32 BatchSet(LL_HANDLE *llHdl, XC02_BLK_BATCH *batch, int32 size);
+static u_int32 MsecToTicks(LL_HANDLE *llHdl, u_int32 msec);
+static int32 AlarmUpdate(LL_HANDLE *llHdl);
+static int32 JobStart(LL_HANDLE *llHdl, u_int32 job, u_int32 msec);
+static int32 JobStop(LL_HANDLE *llHdl, u_int32 job);
+static int32 JobDue(LL_HANDLE *llHdl, u_int32 job, u_int32 now);
+static void JobPeriodSet(LL_HANDLE *llHdl, u_int32 job, u_int32 msec,
+						 u_int32 now);
+static void DownCheck(LL_HANDLE *llHdl, u_int32 now);
+static void SmpTake(LL_HANDLE *llHdl, u_int32 now);
+static void StatUpdate(LL_HANDLE *llHdl, XC02_SMP_REC *rec);
+static void StatGet(LL_HANDLE *llHdl, XC02_BLK_STATS *stats);
+static u_int32 TicksToMsec(LL_HANDLE *llHdl, u_int32 ticks);
+static void EnergyUpdate(LL_HANDLE *llHdl, XC02_SMP_REC *rec);
+static void EnergyGet(LL_HANDLE *llHdl, XC02_BLK_ENERGY *en);
+static int32 ThreshSet(LL_HANDLE *llHdl, XC02_BLK_THRESH *thr, int32 size);
+static int32 ThreshClr(LL_HANDLE *llHdl);
+static void ThreshCheck(LL_HANDLE *llHdl);
+static int32 InSigSet(LL_HANDLE *llHdl, XC02_BLK_IN_SIG *in, int32 size);
+static int32 InSigClr(LL_HANDLE *llHdl);
+static void InCheck(LL_HANDLE *llHdl, u_int32 now);
+static void InEvtGet(LL_HANDLE *llHdl, XC02_BLK_IN_EVT *evt);
+static int32 SubscrAdd(LL_HANDLE *llHdl, u_int32 slot, u_int32 id,
+					   u_int32 signal, u_int32 evtMask);
+static int32 SubscrDel(LL_HANDLE *llHdl, u_int32 slot);
+static int32 SubscrFind(LL_HANDLE *llHdl, u_int32 id);
+static int32 Subscribe(LL_HANDLE *llHdl, XC02_BLK_SUBSCR *sub, int32 size);
+static int32 Unsubscribe(LL_HANDLE *llHdl, u_int32 id);
+static void EvtSend(LL_HANDLE *llHdl, u_int32 evt);
+static void LogAdd(LL_HANDLE *llHdl, u_int8 type, u_int32 data);
+static void LogGet(LL_HANDLE *llHdl, XC02_BLK_LOG *log);
+static void LogSmbErr(LL_HANDLE *llHdl, u_int8 cmd, int32 error);
+static void LogCheck(LL_HANDLE *llHdl);
+static void JobEnd(LL_HANDLE *llHdl, u_int32 job);
+static int32 FadeSet(LL_HANDLE *llHdl, XC02_BLK_FADE *fd, int32 size);
+static int32 FadeStop(LL_HANDLE *llHdl, u_int32 screen);
+static void FadeStep(LL_HANDLE *llHdl, u_int32 now);
+static u_int32 FadeCurve(u_int32 curve, u_int32 x);
+static int32 LutSet(LL_HANDLE *llHdl, XC02_BLK_BR_LUT *lut, int32 size);
+static u_int8 LutInverse(LL_HANDLE *llHdl, u_int8 pwm);
+static int32 AbrSet(LL_HANDLE *llHdl, XC02_BLK_ABR *abr, int32 size);
+static int32 AbrStop(LL_HANDLE *llHdl);
+static void AbrCheck(LL_HANDLE *llHdl);
+static int32 CurveMap(int32 x, const u_int8 *xs, const u_int8 *ys,
+					  u_int32 num);
+static int32 BrWrite(LL_HANDLE *llHdl, u_int32 screen, u_int8 pwm);
+static int32 DerateSet(LL_HANDLE *llHdl, XC02_BLK_DERATE *der, int32 size);
+static int32 DerateStop(LL_HANDLE *llHdl);
+static void DerateCheck(LL_HANDLE *llHdl);
+static void TraceCheck(LL_HANDLE *llHdl, u_int32 now);
+static void TraceGet(LL_HANDLE *llHdl, XC02_BLK_TRACE *trc);
+static void TraceStatGet(LL_HANDLE *llHdl, XC02_BLK_TRACE_STATS *ts);
+static int32 WdTrigger(LL_HANDLE *llHdl);
+static int32 WdLeaseUpdate(LL_HANDLE *llHdl);
+static int32 WdLeaseRenew(LL_HANDLE *llHdl);
+static void WdLeaseCheck(LL_HANDLE *llHdl, u_int32 now);
+static u_int32 WdLeaseLeft(LL_HANDLE *llHdl);
+static u_int32 WdCoalMsec(LL_HANDLE *llHdl);
+static void WdStatGet(LL_HANDLE *llHdl, XC02_BLK_WDOG_STATS *ws);
+static int32 WdRestart(LL_HANDLE *llHdl);
+static int32 WdCliFind(LL_HANDLE *llHdl, u_int32 id);
+static int32 WdCliRegister(LL_HANDLE *llHdl, XC02_BLK_WDOG_CLIENT *reg,
+						   int32 size);
+static int32 WdCliUnregister(LL_HANDLE *llHdl, u_int32 id);
+static int32 WdCliCheckin(LL_HANDLE *llHdl, u_int32 id);
+static void WdStarvedGet(LL_HANDLE *llHdl, XC02_BLK_WDOG_STARVED *st);
+static u_int32 ThreshEval(u_int32 state, int32 val, int32 high, int32 low,
+						  int32 hyst, u_int32 highFlag, u_int32 lowFlag);
 
 /****************************** XC02_GetEntry ********************************/
 /** Initialize driver's jump table
@@ -189,6 +680,9 @@ static int32 XC02_Init(
 	u_int32 	wdogTout, downDelay, offDelay,tempHigh,tempLow;
 	u_int32 	voltHigh, voltLow, brightSource, initState;
 	u_int32 	initBright1, initBright2;
+	u_int32		wordAcc, burstAcc;
+	u_int32		smpPeriod;
+	u_int32		logPeriod;
 
     /*------------------------------+
     |  prepare the handle           |
@@ -257,6 +751,18 @@ static int32 XC02_Init(
 		error != ERR_DESC_KEY_NOTFOUND)
 		return( Cleanup(llHdl,error) );
 
+    /* SMB_WORD_ACCESS */
+    if ((error = DESC_GetUInt32(llHdl->descHdl, TRUE,
+								&wordAcc, "SMB_WORD_ACCESS")) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return( Cleanup(llHdl,error) );
+
+    /* SMB_BURST_READ */
+    if ((error = DESC_GetUInt32(llHdl->descHdl, TRUE,
+								&burstAcc, "SMB_BURST_READ")) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return( Cleanup(llHdl,error) );
+
 	/**
 	 *	required descriptors
 	 */
@@ -353,6 +859,33 @@ static int32 XC02_Init(
 	   error != ERR_DESC_KEY_NOTFOUND )
 		return( Cleanup(llHdl,error));
 
+	/* SAMPLE_PERIOD */
+    if((error = DESC_GetUInt32(llHdl->descHdl, 0,
+							   &smpPeriod, "SAMPLE_PERIOD")) &&
+	   error != ERR_DESC_KEY_NOTFOUND )
+		return( Cleanup(llHdl,error));
+
+	if( smpPeriod && (smpPeriod < SMP_PERIOD_MIN) )
+		return( Cleanup(llHdl,ERR_LL_DESC_PARAM) );
+
+	/* SAMPLE_MASK */
+    if((error = DESC_GetUInt32(llHdl->descHdl, XC02_SMP_MASK_ALL,
+							   &llHdl->smpMask, "SAMPLE_MASK")) &&
+	   error != ERR_DESC_KEY_NOTFOUND )
+		return( Cleanup(llHdl,error));
+
+	if( llHdl->smpMask & ~XC02_SMP_MASK_ALL )
+		return( Cleanup(llHdl,ERR_LL_DESC_PARAM) );
+
+	/* LOG_PERIOD */
+    if((error = DESC_GetUInt32(llHdl->descHdl, 0,
+							   &logPeriod, "LOG_PERIOD")) &&
+	   error != ERR_DESC_KEY_NOTFOUND )
+		return( Cleanup(llHdl,error));
+
+	if( logPeriod && (logPeriod < LOG_PERIOD_MIN) )
+		return( Cleanup(llHdl,ERR_LL_DESC_PARAM) );
+
     /*------------------------------+
     |  get SMB handle               |
     +------------------------------*/
@@ -387,6 +920,21 @@ static int32 XC02_Init(
 								&llHdl->alarmHdl)) )
 		return( Cleanup(llHdl,error));
 
+	if((error = OSS_SpinLockCreate(llHdl->osHdl, &llHdl->smpLock)) )
+		return( Cleanup(llHdl,error));
+
+	if((llHdl->smpRing = (XC02_SMP_REC*)OSS_MemGet(llHdl->osHdl,
+							SMP_RING_SIZE * sizeof(XC02_SMP_REC),
+							&llHdl->smpRingAlloc)) == NULL )
+		return( Cleanup(llHdl,ERR_OSS_MEM_ALLOC));
+
+	llHdl->tickRate = OSS_TickRateGet( llHdl->osHdl );
+	llHdl->almMerge	= MsecToTicks( llHdl, ALM_MERGE_MSEC );
+	if( !llHdl->almMerge )
+		llHdl->almMerge = 1;
+	llHdl->almRun	= JOB_NUM;
+	llHdl->enSince	= OSS_TickGet( llHdl->osHdl );
+
 
     /*------------------------------+
     |  init hardware                |
@@ -472,6 +1020,32 @@ static int32 XC02_Init(
 			return( Cleanup(llHdl,error) );
 	}
 
+	/* read back the configuration registers into the shadow */
+	ShadowInit( llHdl );
+
+	/* use word transactions for 16 bit registers if the PIC supports them */
+	if( wordAcc )
+		WordAccProbe( llHdl );
+
+	/* read contiguous registers with one I2C transfer if possible */
+	if( burstAcc )
+		BurstProbe( llHdl );
+
+	llHdl->batchFailIdx = -1;
+
+	/* default brightness LUT: linear, level 255 is brightest */
+	for( i=0; i<BR_LUT_SIZE; i++ )
+		llHdl->brLut[i] = (u_int8)(BR_MAX - (i*BR_MAX + 127)/255);
+	llHdl->derCapLvl = BR_LUT_SIZE-1;
+
+	/* start the telemetry sampler */
+	if( smpPeriod && (error = JobStart( llHdl, JOB_SMP, smpPeriod )) )
+		return( Cleanup(llHdl,error) );
+
+	/* start the event log poll */
+	if( logPeriod && (error = JobStart( llHdl, JOB_LOG, logPeriod )) )
+		return( Cleanup(llHdl,error) );
+
 	*llHdlP = llHdl;	/* set low-level driver handle */
 
 	return(ERR_SUCCESS);
@@ -574,7 +1148,6 @@ static int32 XC02_SetStat(
 )
 {
 	int32	error = ERR_SUCCESS;
-	u_int32 wdtime=0;
 
 	int32	    value  = (int32)value32_or_64;	/* 32bit value */
 	INT32_OR_64	valueP = value32_or_64;	        /* stores 32/64bit pointer */
@@ -596,58 +1169,6 @@ static int32 XC02_SetStat(
 			if( value != M_CH_INOUT )
 				error = ERR_LL_ILL_DIR;
             break;
-        /*--------------------------+
-        |  WOT                      |
-        +--------------------------*/
-        case XC02_WOT:
-			if( value > 0xffff ){
-				error = ERR_LL_ILL_PARAM;
-				break;
-			}
-			DBGWRT_2((DBH, " - XC02_WOT: WOT= %d min\n", value));
-
-			SMB_W_BYTE( XC02C_WOT_L,      value & 0xff );
-			SMB_W_BYTE( XC02C_WOT_H, (value>>8) & 0xff );
-			break;
-
-        /*--------------------------+
-        |  SWOFF                    |
-        +--------------------------*/
-        case XC02_SWOFF:
-			/* here we expect XC02C_SWOFF_MAGIC as value */
-			DBGWRT_2((DBH, " - XC02_SWOFF: value = 0x%x min\n", value));
-			SMB_W_BYTE( XC02C_SWOFF, (value & 0xff) );
-			break;
-        /*--------------------------+
-        |  OFFACK                   |
-        +--------------------------*/
-        case XC02_OFFACK:
-			DBGWRT_2((DBH, " - XC02_OFFACK\n"));
-			SMB_W_BYTE( XC02C_OFFACK, XC02C_FLAG );
-			break;
-        /*--------------------------+
-        |  DOWN_DELAY               |
-        +--------------------------*/
-        case XC02_DOWN_DELAY:
-			if( (value < XC02C_DOWN_DELAY_MINMODE) ||
-				(value > XC02C_DOWN_DELAY_MAXMODE) ){
-				error = ERR_LL_ILL_PARAM;
-				break;
-			}
-			DBGWRT_2((DBH, " - XC02_DOWN_DELAY: value = %d\n", value));
-			SMB_W_BYTE( XC02C_DOWN_DELAY, value );
-			break;
-        /*--------------------------+
-        |  OFF_DELAY                |
-        +--------------------------*/
-        case XC02_OFF_DELAY:
-			if( (value < XC02C_OD_MINMODE) || (value > XC02C_OD_MAXMODE) ){
-				error = ERR_LL_ILL_PARAM;
-				break;
-			}
-			DBGWRT_2((DBH, " - XC02_OFF_DELAY: value = %d\n", value));
-			SMB_W_BYTE( XC02C_OFF_DELAY, value );
-			break;
 
         /*------------------------------------+
         |  install signal for shutdown event  |
@@ -656,33 +1177,52 @@ static int32 XC02_SetStat(
 		{
 			M_SG_BLOCK			*blk = (M_SG_BLOCK*)valueP;
 			XC02_BLK_DOWN_SIG	*alm = (XC02_BLK_DOWN_SIG*)blk->data;
-			u_int32				realMsec;
 
-			/* check buf size */
-			if( blk->size < sizeof(XC02_BLK_DOWN_SIG) )
+			/* check buf size (mode, rearm, min/maxMsec are optional) */
+			if( blk->size < DOWN_SIG_SIZE_V1 )
 				return(ERR_LL_USERBUF);
 
-			/* illegal signal code ? */
-			if( alm->signal == 0 ){
-				DBGWRT_ERR((DBH, " *** XC02_SetStat: illegal signal code=0x%x",
-					alm->signal));
+			/* illegal poll period or mode ? */
+			if( (alm->msec == 0) ||
+				((blk->size >= DOWN_SIG_SIZE_V2) &&
+				 (alm->mode > XC02_DOWN_SIG_EDGE)) ||
+				((blk->size >= sizeof(XC02_BLK_DOWN_SIG)) &&
+				 (alm->minMsec || alm->maxMsec) &&
+				 (!alm->minMsec || (alm->minMsec > alm->maxMsec))) ){
+				DBGWRT_ERR((DBH, " *** XC02_SetStat: illegal parameter"));
 				return(ERR_LL_ILL_PARAM);
 			}
 
 			/* already defined ? */
-			if( llHdl->sigHdl != NULL ){
+			if( llHdl->job[JOB_DOWN].msec ){
 				DBGWRT_ERR((DBH, " *** XC02_SetStat: signal already instaled"));
 				return(ERR_OSS_SIG_SET);
 			}
 			DBGWRT_2((DBH, " - XC02_BLK_DOWN_SIG_SET\n"));
 			/* install signal+alarm */
-			if( (error = OSS_SigCreate(llHdl->osHdl,
-									   alm->signal, &llHdl->sigHdl)) )
+			if( (error = SubscrAdd( llHdl, SUBSCR_DOWN, 0, alm->signal,
+									XC02_EVT_DOWN )) )
 				return(error);
 
-            if( (error = OSS_AlarmSet(llHdl->osHdl, llHdl->alarmHdl,
-									  alm->msec, 1, &realMsec)) )
+			llHdl->downMode	   = XC02_DOWN_SIG_LEVEL;
+			llHdl->downRearm   = 0;
+			llHdl->downMaxMsec = 0;
+			if( blk->size >= DOWN_SIG_SIZE_V2 ){
+				llHdl->downMode	 = alm->mode;
+				llHdl->downRearm = alm->rearm;
+			}
+			/* adaptive: alarm runs with minMsec, polls start there */
+			if( (blk->size >= sizeof(XC02_BLK_DOWN_SIG)) && alm->maxMsec )
+				llHdl->downMaxMsec = alm->maxMsec;
+			llHdl->downPend	 = 0;
+			llHdl->downSuppr = 0;
+			llHdl->downQuiet = 0;
+
+			if( (error = JobStart( llHdl, JOB_DOWN, llHdl->downMaxMsec ?
+								   alm->minMsec : alm->msec )) ){
+				SubscrDel( llHdl, SUBSCR_DOWN );
 				return(error);
+			}
             break;
 		}
         /*---------------------------------------+
@@ -690,134 +1230,326 @@ static int32 XC02_SetStat(
         +---------------------------------------*/
         case XC02_DOWN_SIG_CLR:
 			/* not defined ? */
-			if( llHdl->sigHdl == NULL ){
+			if( llHdl->job[JOB_DOWN].msec == 0 ){
 				DBGWRT_ERR((DBH, " *** XC02_SetStat: signal not installed"));
 				return(ERR_OSS_SIG_CLR);
 			}
 			DBGWRT_2((DBH, " - XC02_BLK_DOWN_SIG_CLR\n"));
   			/* remove signal+alarm */
-			if( (error = OSS_SigRemove(llHdl->osHdl, &llHdl->sigHdl)) )
+			if( (error = JobStop( llHdl, JOB_DOWN )) )
 				return(error);
 
-			if( (error = OSS_AlarmClear(llHdl->osHdl, llHdl->alarmHdl)) )
+			if( (error = SubscrDel( llHdl, SUBSCR_DOWN )) )
 				return(error);
 
             break;
 
         /*--------------------------+
-        |  TEMP_HIGH                |
+        |  batch of setstats        |
         +--------------------------*/
-        case XC02_TEMP_HIGH:
-			if( (value < TEMP_RANGE_MIN) || (value > TEMP_RANGE_MAX )){
-				error = ERR_LL_ILL_PARAM;
-				break;
-			}
-			DBGWRT_2((DBH, " - XC02_TEMP_HIGH: %d degree (0x%02x)\n",
-					  XC02_TEMP2ADC(value), value ));
-			SMB_W_BYTE( XC02C_TEMP_HIGH, XC02_TEMP2ADC(value));
+        case XC02_BLK_BATCH_SET:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
+
+			error = BatchSet( llHdl, (XC02_BLK_BATCH*)blk->data, blk->size );
 			break;
+		}
+
+        /*--------------------------+
+        |  warning thresholds       |
+        +--------------------------*/
+        case XC02_BLK_THRESH_SET:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
 
+			error = ThreshSet( llHdl, (XC02_BLK_THRESH*)blk->data, blk->size );
+			break;
+		}
+        case XC02_THRESH_CLR:
+			error = ThreshClr( llHdl );
+			break;
 
         /*--------------------------+
-        |  TEMP_LOW                 |
+        |  input change signal      |
         +--------------------------*/
-        case XC02_TEMP_LOW:
+        case XC02_BLK_IN_SIG_SET:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
 
-			if ( (value < TEMP_RANGE_MIN ) || (value > TEMP_RANGE_MAX )) {
-				error = ERR_LL_ILL_PARAM;
-				break;
-			}
-			DBGWRT_2((DBH, " - XC02_TEMP_LOW: %d degree (0x%02x)\n",
-					  XC02_TEMP2ADC(value), value ));
-			/* value is in degree celsius */
-			SMB_W_BYTE( XC02C_TEMP_LOW, XC02_TEMP2ADC(value) );
+			error = InSigSet( llHdl, (XC02_BLK_IN_SIG*)blk->data, blk->size );
+			break;
+		}
+        case XC02_IN_SIG_CLR:
+			error = InSigClr( llHdl );
 			break;
 
         /*--------------------------+
-        |  brightness source        |
+        |  event subscribers        |
         +--------------------------*/
-        case XC02_BR_SRC:
-			if ( (value !=0) && (value !=1)) {
-				error = ERR_LL_ILL_PARAM;
-				break;
-			}
-			DBGWRT_2((DBH, " - XC02_BR_SRC: src = %d\n", value ));
-			SMB_W_BYTE(	XC02C_BR_SRC, value );
+        case XC02_BLK_SUBSCRIBE:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
+
+			error = Subscribe( llHdl, (XC02_BLK_SUBSCR*)blk->data, blk->size );
+			break;
+		}
+        case XC02_UNSUBSCRIBE:
+			error = Unsubscribe( llHdl, (u_int32)value );
 			break;
 
         /*--------------------------+
-        |  brightness multiplier    |
+        |  event log                |
         +--------------------------*/
-        case XC02_BR_MULT:
-			/* allow factors 0..10, default = 1 */
-			if ( (value < 0) || (value > 100)) {
+        case XC02_LOG_PERIOD:
+			if( value == 0 )
+				error = JobStop( llHdl, JOB_LOG );
+			else if( value < LOG_PERIOD_MIN )
 				error = ERR_LL_ILL_PARAM;
-				break;
+			else {
+				llHdl->logPolled = 0;
+				error = JobStart( llHdl, JOB_LOG, value );
 			}
-			DBGWRT_2((DBH, " - XC02_BR_MULT: %d\n", value ));
-			SMB_W_BYTE(	XC02C_AUTO_BR_FAK, value );
 			break;
 
+        /*--------------------------+
+        |  brightness fade          |
+        +--------------------------*/
+        case XC02_BLK_FADE_SET:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
+
+			error = FadeSet( llHdl, (XC02_BLK_FADE*)blk->data, blk->size );
+			break;
+		}
+        case XC02_FADE_STOP:
+			DBGWRT_2((DBH, " - XC02_FADE_STOP: screen=%d\n", value));
+			error = FadeStop( llHdl, (u_int32)value );
+			break;
 
         /*--------------------------+
-        |  brightness offset        |
+        |  logical brightness       |
         +--------------------------*/
-        case XC02_BR_OFFS:
-			if ( (value < 0) || (value > 0xfe)) {
-				error = ERR_LL_ILL_PARAM;
-				break;
-			}
-			DBGWRT_2((DBH, " - XC02_BR_OFFS: %d\n", value ));
-			SMB_W_BYTE(	XC02C_AUTO_BR_OFFS, value );
+        case XC02_BLK_BR_LUT_SET:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
+
+			error = LutSet( llHdl, (XC02_BLK_BR_LUT*)blk->data, blk->size );
+			break;
+		}
+        case XC02_BR_LEVEL:
+			DBGWRT_2((DBH, " - XC02_BR_LEVEL: ch=%d level=%d\n", ch, value));
+			if( (ch >= FADE_NUM) || (value < 0) || (value >= BR_LUT_SIZE) )
+				return(ERR_LL_ILL_PARAM);
+			FadeStop( llHdl, ch );
+			error = BrWrite( llHdl, ch, llHdl->brLut[value] );
+			break;
+
+        /*--------------------------+
+        |  auto brightness          |
+        +--------------------------*/
+        case XC02_BLK_ABR_SET:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
+
+			error = AbrSet( llHdl, (XC02_BLK_ABR*)blk->data, blk->size );
+			break;
+		}
+        case XC02_ABR_STOP:
+			error = AbrStop( llHdl );
+			break;
+
+        /*--------------------------+
+        |  thermal derating         |
+        +--------------------------*/
+        case XC02_BLK_DERATE_SET:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
+
+			error = DerateSet( llHdl, (XC02_BLK_DERATE*)blk->data,
+							   blk->size );
+			break;
+		}
+        case XC02_DERATE_STOP:
+			error = DerateStop( llHdl );
 			break;
 
         /*--------------------------+
-        | switch display            |
+        |  firmware state tracer    |
         +--------------------------*/
-        case XC02_SW_DISP:
-			if ( (value >=0 ) && (value <=3 )) {
-				DBGWRT_2((DBH, " - XC02_SW_DISP: value = %d\n", value ));
-				SMB_W_BYTE( XC02C_SW_DISP, value );
-			} else {
+        case XC02_TRACE_PERIOD:
+			DBGWRT_2((DBH, " - XC02_TRACE_PERIOD: %dms\n", value));
+			if( value == 0 )
+				error = JobStop( llHdl, JOB_TRACE );
+			else if( value < TRC_PERIOD_MIN )
 				error = ERR_LL_ILL_PARAM;
+			else {
+				/* current stay is unknown after a pause */
+				if( !llHdl->job[JOB_TRACE].msec )
+					llHdl->trcVld = 0;
+				error = JobStart( llHdl, JOB_TRACE, value );
 			}
 			break;
 
         /*--------------------------+
-        | initial display status    |
+        |  watchdog heartbeat       |
         +--------------------------*/
-        case XC02_DISP_INITSTAT:
-			if ( (value >=0 ) && (value <=3 )) {
-				DBGWRT_2((DBH, " - XC02_DISP_INITSTAT: value = %d\n", value ));
-				SMB_W_BYTE( XC02C_INIT_DS, value );
-			} else {
+        case XC02_WDOG_LEASE:
+			DBGWRT_2((DBH, " - XC02_WDOG_LEASE: %dms\n", value));
+			if( (value != 0) && (value < WD_LEASE_MIN) ){
 				error = ERR_LL_ILL_PARAM;
 				break;
 			}
+			llHdl->wdLease = value;
+			error = WdRestart( llHdl );
+			break;
+        case XC02_WDOG_COALESCE:
+			DBGWRT_2((DBH, " - XC02_WDOG_COALESCE: %d\n", value));
+			if( (value != 0) &&
+				((value < WD_COAL_MIN) || (value > WD_COAL_MAX)) )
+				error = ERR_LL_ILL_PARAM;
+			else
+				llHdl->wdCoal = value;
+			break;
+        case XC02_BLK_WDOG_REGISTER:
+		{
+			M_SG_BLOCK		*blk = (M_SG_BLOCK*)valueP;
+
+			error = WdCliRegister( llHdl, (XC02_BLK_WDOG_CLIENT*)blk->data,
+								   blk->size );
+			break;
+		}
+        case XC02_WDOG_UNREGISTER:
+			error = WdCliUnregister( llHdl, (u_int32)value );
+			break;
+        case XC02_WDOG_CHECKIN:
+			error = WdCliCheckin( llHdl, (u_int32)value );
 			break;
 
         /*--------------------------+
-        | brightness direction      |
+        |  telemetry sampler        |
         +--------------------------*/
-        case XC02_BRIGHT_DIRECTION:
-			if ( (value == 0 ) || (value == 1 )) {
-				DBGWRT_2((DBH, " - XC02_BRIGHT_DIRECTION: value = %d\n", value ));
-				SMB_W_BYTE( SC21C_BR_DIR, value );
-			} else {
+        case XC02_SMP_PERIOD:
+			if( value == 0 )
+				error = JobStop( llHdl, JOB_SMP );
+			else if( value < SMP_PERIOD_MIN )
 				error = ERR_LL_ILL_PARAM;
-				break;
-			}
+			else
+				error = JobStart( llHdl, JOB_SMP, value );
+			break;
+        case XC02_SMP_MASK:
+			if( value & ~XC02_SMP_MASK_ALL )
+				return(ERR_LL_ILL_PARAM);
+			llHdl->smpMask = value;
+			break;
+        case XC02_SMP_COUNT:
+			OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+			llHdl->smpCnt  = 0;
+			llHdl->smpLost = 0;
+			OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+			break;
+
+		/*--------------------------+
+        |  register based codes     |
+        +--------------------------*/
+        default:
+			if( (error = RegSetCheck( code, ch, value )) == ERR_SUCCESS )
+				error = RegSet( llHdl, code, ch, value );
+    }
+
+	return(error);
+}
+
+/******************************** RegSetCheck ********************************/
+/** Check the parameters of a register based setstat code
+ *
+ *  Used by XC02_SetStat() and for the up-front validation of
+ *  #XC02_BLK_BATCH_SET.
+ *
+ *  \param code       \IN  \ref getstat_setstat_codes "status code"
+ *  \param ch         \IN  Current channel
+ *  \param value      \IN  value to set
+ *
+ *  \return           \c 0 if value valid, ERR_LL_ILL_PARAM or ERR_LL_UNK_CODE
+ */
+static int32 RegSetCheck( int32 code, int32 ch, int32 value )
+{
+	const REG_DESC	*d = RegDescGet( code );
+	u_int32			wdtime;
+
+	/* XC02 codes: check against the register descriptor */
+	if( d ){
+		if( !(d->acc & ACC_W) )
+			return(ERR_LL_UNK_CODE);
+
+		if( (value < d->min) || (value > d->max) )
+			return(ERR_LL_ILL_PARAM);
+
+		/* current channel selects display 0 or 1 */
+		if( (d->conv == CONV_CHAN) && (ch != 0) && (ch != 1) )
+			return(ERR_LL_ILL_PARAM);
+
+		return(ERR_SUCCESS);
+	}
+
+	/* watchdog codes */
+	switch(code) {
+        case WDOG_TIME:
+			wdtime = value/100;
+			if( (wdtime < XC02C_WDOG_TOUT_MINMODE) ||
+				(wdtime > XC02C_WDOG_TOUT_MAXMODE) )
+				return(ERR_LL_ILL_PARAM);
+			break;
+        case WDOG_START:
+        case WDOG_STOP:
+        case WDOG_TRIG:
 			break;
+        default:
+			return(ERR_LL_UNK_CODE);
+	}
+
+	return(ERR_SUCCESS);
+}
+
+/********************************** RegSet ***********************************/
+/** Execute a register based setstat code
+ *
+ *  The parameters must have been checked with RegSetCheck() before.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param code       \IN  \ref getstat_setstat_codes "status code"
+ *  \param ch         \IN  Current channel
+ *  \param value      \IN  value to set
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 RegSet( LL_HANDLE *llHdl, int32 code, int32 ch, int32 value )
+{
+	const REG_DESC	*d = RegDescGet( code );
+	int32			error = ERR_SUCCESS;
+	u_int32			wdtime=0;
+
+	/* a direct brightness write ends a running fade */
+	if( (code == XC02_BRIGHTNESS) || (code == XC02_BRIGHTNESS2) ){
+		FadeStop( llHdl, code == XC02_BRIGHTNESS2 );
+		return( BrWrite( llHdl, code == XC02_BRIGHTNESS2, (u_int8)value ) );
+	}
 
+	if( d )
+		return( RegDescSetStat( llHdl, d, ch, value ) );
+
+    switch(code) {
         /*--------------------------+
         |  start WDOG               |
         +--------------------------*/
         case WDOG_START:
 			DBGWRT_2((DBH, " - XC02_WDOG_START\n" ));
-			SMB_W_BYTE( XC02C_WDOG_STATE, XC02C_WDOG_ON );
+			error = RegWrite( llHdl, XC02C_WDOG_STATE, XC02C_WDOG_ON );
  			if( error )
 				break;
-			llHdl->wdState = 1;
+			llHdl->wdState	 = 1;
+			llHdl->wdTrigVld = 0;
+			LogAdd( llHdl, XC02_LOG_WDOG_START, 0 );
+			error = WdRestart( llHdl );
            break;
 
         /*--------------------------+
@@ -825,10 +1557,12 @@ static int32 XC02_SetStat(
         +--------------------------*/
         case WDOG_STOP:
 			DBGWRT_2((DBH, " - XC02_WDOG_STOP\n" ));
-			SMB_W_BYTE( XC02C_WDOG_STATE, XC02C_WDOG_OFF );
+			error = RegWrite( llHdl, XC02C_WDOG_STATE, XC02C_WDOG_OFF );
 			if( error  )
 				break;
 			llHdl->wdState = 0;
+			LogAdd( llHdl, XC02_LOG_WDOG_STOP, 0 );
+			error = WdLeaseUpdate( llHdl );
             break;
 
         /*--------------------------+
@@ -840,100 +1574,26 @@ static int32 XC02_SetStat(
 				error = ERR_LL_DEV_NOTRDY;
 				break;
 			}
-			DBGWRT_2((DBH, " - XC02_WDOG_TRIG\n" ));
-			SMB_W_BYTE( XC02C_WDOG_TRIG, XC02C_FLAG );
+			/* heartbeat mode: driver triggers, just renew the lease */
+			if( llHdl->wdLease )
+				error = WdLeaseRenew( llHdl );
+			/* clients registered: only they can keep the watchdog alive */
+			else if( llHdl->wdCliNum )
+				error = ERR_LL_DEV_BUSY;
+			else
+				error = WdTrigger( llHdl );
             break;
         /*--------------------------+
         |  WDOG time in ms          |
         +--------------------------*/
         case WDOG_TIME:
-			/* check range */
 			wdtime = value/100;
-			if( (wdtime < XC02C_WDOG_TOUT_MINMODE) ||
-				( wdtime > XC02C_WDOG_TOUT_MAXMODE) ){
-					error = ERR_LL_ILL_PARAM;
-					break;
-			}
 			DBGWRT_2((DBH, " - XC02_WDOG_TIME: %d ms \n", wdtime*100 ));
-			SMB_W_BYTE( XC02C_WDOG_TOUT, wdtime );
+			error = RegWrite( llHdl, XC02C_WDOG_TOUT, wdtime );
+			if( !error )
+				error = WdLeaseUpdate( llHdl );
             break;
 
-        /*--------------------------+
-        |  Test registers #1..2     |
-		|  (for PIC firmware test)  |
-        +--------------------------*/
-	    case XC02_TEST1:
-			 DBGWRT_2((DBH, " - XC02_TEST1\n"));
-			 SMB_W_BYTE( XC02C_TEST1, value );
-			break;
-
-        case XC02_TEST2:
-			DBGWRT_1((DBH, " - XC02_TEST2\n"));
-			SMB_W_BYTE( XC02C_TEST2, value );
-			break;
-
-        /*--------------------------+
-        |  prim. display brightness |
-        +--------------------------*/
-	    case XC02_BRIGHTNESS:
-			DBGWRT_1((DBH, " - XC02_BRIGHTNESS\n"));
-			SMB_W_BYTE( XC02C_SET_BR, value & 0xff );
-			break;
-
-		/*--------------------------+
-        | initial display brightness|
-        +--------------------------*/
-	    case XC02_INIT_BRIGHT:
-			/* set initial brightness for display 0 or 1,
-			 *   current channel selects display */
-			switch (ch) {
-			case 0:
-				SMB_W_BYTE( XC02C_INIT_BR1, value & 0xff );
-				break;
-			case 1:
-				SMB_W_BYTE( XC02C_INIT_BR2, value & 0xff );
-				break;
-			default:
-				DBGWRT_ERR((DBH," *** XC02_INIT_BRIGHT: illegal chan. %d\n",
-							ch));
-				error = ERR_LL_ILL_PARAM;
-			}
-			break;
-
-		/* next 2 are effective on DC1 Rev 01 only */
-        /*--------------------------+
-        | brightness 2nd display    |
-        +--------------------------*/
-	    case XC02_BRIGHTNESS2:
-			DBGWRT_1((DBH, " - XC02_BRIGHTNESS2\n"));
-			SMB_W_BYTE( XC02C_SET_BR_2, value & 0xff );
-			break;
-
-        /*--------------------------+
-        |  minicard slot power      |
-        +--------------------------*/
-	    case XC02_MINICARD_PWR:
-			DBGWRT_1((DBH, " - XC02_MINICARD_PWR\n"));
-			SMB_W_BYTE( XC02C_SW_MINICARD, value & 0xff );
-			break;
-
-        /*--------------------------+
-        |  KEY_IN behavior control  |
-        +--------------------------*/
-	    case XC02_KEY_IN_CTRL:
-			DBGWRT_1((DBH, " - XC02_KEY_IN_CTRL\n"));
-			SMB_W_BYTE( SC21C_KEY_CTRL, value & 0x01 );
-			break;
-
-        /*--------------------------+
-        |  auto brightness behavior |
-        +--------------------------*/
-	    case XC02_AUTO_BRIGHT_CTRL:
-			DBGWRT_1((DBH, " - XC02_AUTO_BRIGHT_CTRL\n"));
-			SMB_W_BYTE( SC21C_BR_DIR, value & 0x01 );
-			break;
-
-
 		/*--------------------------+
         |  unknown                  |
         +--------------------------*/
@@ -944,21 +1604,181 @@ static int32 XC02_SetStat(
 	return(error);
 }
 
-/****************************** XC02_GetStat *********************************/
-/** Get the driver status
- *
- *  The driver supports \ref getstat_setstat_codes "these status codes"
- *  in addition to the standard codes (see mdis_api.h).
+/******************************** RegDescGet *********************************/
+/** Look up the register descriptor of an XC02 status code
  *
- *  \param llHdl      		\IN  Low-level handle
- *  \param code       		\IN  \ref getstat_setstat_codes "status code"
- *  \param ch         		\IN  Current channel
- *  \param value32_or_64P	\IN  Pointer to block data structure (M_SG_BLOCK) for
- *                         			block status codes
- *  \param value32_or_64P	\OUT Data pointer or pointer to block data structure
- *                         			(M_SG_BLOCK) for block status codes
+ *  \param code       \IN  \ref getstat_setstat_codes "status code"
  *
- *  \return           \c 0 On success or error code
+ *  \return           descriptor or NULL if code is not register based
+ */
+static const REG_DESC* RegDescGet( int32 code )
+{
+	u_int32	idx = (u_int32)(code - M_DEV_OF);
+
+	if( (idx >= REG_DESC_NUM) || (G_RegDesc[idx].acc == 0) )
+		return( NULL );
+
+	return( &G_RegDesc[idx] );
+}
+
+/****************************** RegDescGetStat *******************************/
+/** Read and convert the register(s) described by a register descriptor
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param d          \IN  register descriptor
+ *  \param ch         \IN  Current channel
+ *  \param valueP     \OUT converted value
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 RegDescGetStat(
+	LL_HANDLE		*llHdl,
+	const REG_DESC	*d,
+	int32			ch,
+	int32			*valueP )
+{
+	int32	error;
+	u_int8	lVal, hVal = 0;
+	u_int16	wVal;
+
+	switch( d->conv ){
+	case CONV_WORD:
+		if( (error = Reg16Read( llHdl, d->cmd, &wVal )) )
+			return( error );
+		lVal = (u_int8)(wVal & 0xff);
+		hVal = (u_int8)(wVal >> 8);
+		break;
+	case CONV_CHAN:
+		if( (ch != 0) && (ch != 1) ){
+			DBGWRT_ERR((DBH," *** %s: illegal chan. %d\n", d->name, ch));
+			return( ERR_LL_ILL_PARAM );
+		}
+		if( (error = RegRead( llHdl, d->cmd + ch, &lVal )) )
+			return( error );
+		break;
+	default:
+		if( (error = RegRead( llHdl, d->cmd, &lVal )) )
+			return( error );
+	}
+
+	*valueP = (int32)((hVal<<8 | lVal) & d->mask);
+
+	if( d->conv == CONV_TEMP )
+		*valueP = XC02_ADC2TEMP(*valueP);
+
+	DBGWRT_2((DBH, " - %s:= %d\n", d->name, *valueP ));
+
+	return( ERR_SUCCESS );
+}
+
+/****************************** RegDescSetStat *******************************/
+/** Convert and write a value to the register(s) of a register descriptor
+ *
+ *  The value must have been checked with RegSetCheck() before.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param d          \IN  register descriptor
+ *  \param ch         \IN  Current channel
+ *  \param value      \IN  value to set
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 RegDescSetStat(
+	LL_HANDLE		*llHdl,
+	const REG_DESC	*d,
+	int32			ch,
+	int32			value )
+{
+	DBGWRT_2((DBH, " - %s: value = %d\n", d->name, value ));
+
+	switch( d->conv ){
+	case CONV_TEMP:
+		/* value is in degree celsius */
+		return( RegWrite( llHdl, d->cmd, XC02_TEMP2ADC(value) ) );
+	case CONV_FLAG:
+		return( RegWrite( llHdl, d->cmd, XC02C_FLAG ) );
+	case CONV_WORD:
+		return( Reg16Write( llHdl, d->cmd, (u_int16)(value & d->mask) ) );
+	case CONV_CHAN:
+		return( RegWrite( llHdl, d->cmd + ch, value & d->mask ) );
+	default:
+		return( RegWrite( llHdl, d->cmd, value & d->mask ) );
+	}
+}
+
+/********************************* BatchSet **********************************/
+/** Apply a batch of register based setstat codes
+ *
+ *  All entries are checked with RegSetCheck() first, nothing is written if
+ *  one of them is invalid. Then the entries are applied back-to-back within
+ *  the single MDIS call lock (LL_LOCK_CALL), stopping at the first failing
+ *  entry. The result can be read with #XC02_BATCH_APPLIED and
+ *  #XC02_BATCH_FAILIDX.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param batch      \IN  batch to apply
+ *  \param size       \IN  size of batch data [bytes]
+ *
+ *  \return           \c 0 On success or error code of the failing entry
+ */
+static int32 BatchSet( LL_HANDLE *llHdl, XC02_BLK_BATCH *batch, int32 size )
+{
+	int32	error = ERR_SUCCESS;
+	u_int32	i;
+
+	llHdl->batchApplied = 0;
+	llHdl->batchFailIdx = -1;
+
+	/* check buf size */
+	if( (size < (int32)sizeof(batch->num)) ||
+		(batch->num > XC02_BATCH_MAX) ||
+		(size < (int32)(sizeof(batch->num) +
+						batch->num * sizeof(XC02_BATCH_ENTRY))) )
+		return(ERR_LL_USERBUF);
+
+	DBGWRT_2((DBH, " - XC02_BLK_BATCH_SET: num=%d\n", batch->num));
+
+	/* validate the whole batch up front */
+	for( i=0; i<batch->num; i++ ){
+		if( (error = RegSetCheck( batch->entry[i].code, batch->entry[i].ch,
+								  batch->entry[i].value )) ){
+			DBGWRT_ERR((DBH, " *** BatchSet: entry %d code=0x%04x invalid\n",
+						i, batch->entry[i].code));
+			llHdl->batchFailIdx = i;
+			return(error);
+		}
+	}
+
+	/* issue the writes back-to-back */
+	for( i=0; i<batch->num; i++ ){
+		if( (error = RegSet( llHdl, batch->entry[i].code, batch->entry[i].ch,
+							 batch->entry[i].value )) ){
+			DBGWRT_ERR((DBH, " *** BatchSet: entry %d code=0x%04x failed\n",
+						i, batch->entry[i].code));
+			llHdl->batchFailIdx = i;
+			break;
+		}
+		llHdl->batchApplied++;
+	}
+
+	return(error);
+}
+
+/****************************** XC02_GetStat *********************************/
+/** Get the driver status
+ *
+ *  The driver supports \ref getstat_setstat_codes "these status codes"
+ *  in addition to the standard codes (see mdis_api.h).
+ *
+ *  \param llHdl      		\IN  Low-level handle
+ *  \param code       		\IN  \ref getstat_setstat_codes "status code"
+ *  \param ch         		\IN  Current channel
+ *  \param value32_or_64P	\IN  Pointer to block data structure (M_SG_BLOCK) for
+ *                         			block status codes
+ *  \param value32_or_64P	\OUT Data pointer or pointer to block data structure
+ *                         			(M_SG_BLOCK) for block status codes
+ *
+ *  \return           \c 0 On success or error code
  */
 static int32 XC02_GetStat(
     LL_HANDLE *llHdl,
@@ -1022,305 +1842,276 @@ static int32 XC02_GetStat(
            *value64P = (INT32_OR_64)&llHdl->idFuncTbl;
            break;
         /*--------------------------+
-        |  WOT                      |
+        |  WDOG time in ms          |
         +--------------------------*/
-        case XC02_WOT:
-		{
-			u_int8 lVal, hVal;
-
-			SMB_R_BYTE( XC02C_WOT_L, &lVal );
-			if( error  )
-				break;
-
-			SMB_R_BYTE( XC02C_WOT_H, &hVal );
-			if( error  )
-				break;
-
-			*valueP = (int32)(hVal<<8 | lVal);
-			DBGWRT_2((DBH, " - XC02_WOT:= %d min\n", *valueP ));
-			break;
-		}
+        case WDOG_TIME:
+			error = RegRead( llHdl, XC02C_WDOG_TOUT, &regVal );
+			*valueP = (int32)(regVal * 100);
+			DBGWRT_2((DBH, " - WDOG_TIME:= %d\n", *valueP ));
+            break;
 
         /*--------------------------+
-        |  WDOG_ERR                 |
+        |  WDOG status              |
         +--------------------------*/
-        case XC02_WDOG_ERR:
-			SMB_R_BYTE( XC02C_WDOG_ERR, valueP );
-			DBGWRT_2((DBH, " - XC02_WDOG_ERR:= %d\n", *valueP ));
-			break;
+        case WDOG_STATUS:
+			error = RegRead( llHdl, XC02C_WDOG_STATE, &regVal );
+			*valueP = (int32)regVal;
+			DBGWRT_2((DBH, " - WDOG_STATUS:= %d\n", *valueP ));
+            break;
+
         /*--------------------------+
-        |  DOWN_DELAY               |
+        |  WDOG shot                |
         +--------------------------*/
-        case XC02_DOWN_DELAY:
-			SMB_R_BYTE( XC02C_DOWN_DELAY, valueP );
-			DBGWRT_2((DBH, " - XC02_DOWN_DELAY:= %d\n", *valueP ));
-			break;
+        case WDOG_SHOT:
+			error = RegRead( llHdl, XC02C_WDOG_ERR, &regVal );
+			*valueP = (int32)(regVal ? 1 : 0);
+			DBGWRT_2((DBH, " - WDOG_SHOT:= %d\n", *valueP ));
+            break;
+
         /*--------------------------+
-        |  OFF_DELAY                |
+        |  last batch result        |
         +--------------------------*/
-        case XC02_OFF_DELAY:
-			SMB_R_BYTE( XC02C_OFF_DELAY, valueP );
-			DBGWRT_2((DBH, " - XC02_OFF_DELAY:= %d\n", *valueP ));
+	    case XC02_BATCH_APPLIED:
+			*valueP = (int32)llHdl->batchApplied;
 			break;
-        /*--------------------------+
-        |  DOWN_EVT                 |
-        +--------------------------*/
-        case XC02_DOWN_EVT:
-			SMB_R_BYTE( XC02C_STATUS, &regVal );
-			*valueP = (int32)(regVal & 0x3);
-			DBGWRT_2((DBH, " - XC02_STATUS:= %d\n", *valueP ));
+	    case XC02_BATCH_FAILIDX:
+			*valueP = llHdl->batchFailIdx;
 			break;
+
         /*--------------------------+
-        |  IN                       |
+        |  telemetry sampler        |
         +--------------------------*/
-        case XC02_IN:
-			SMB_R_BYTE( XC02C_IN, valueP );
-			DBGWRT_2((DBH, " - XC02_IN:= %d\n", *valueP ));
+	    case XC02_SMP_PERIOD:
+			*valueP = (int32)llHdl->job[JOB_SMP].msec;
+			break;
+	    case XC02_SMP_MASK:
+			*valueP = (int32)llHdl->smpMask;
+			break;
+	    case XC02_SMP_COUNT:
+			*valueP = (int32)llHdl->smpCnt;
+			break;
+	    case XC02_SMP_LOST:
+			*valueP = (int32)llHdl->smpLost;
 			break;
 
         /*--------------------------+
-        | timestamp  (char wise)    |
+        |  warning thresholds       |
         +--------------------------*/
-	    case XC02_TIMESTAMP:
-			SMB_R_BYTE( XC02C_TIMESTAMP, valueP );
-			DBGWRT_2((DBH, " - XC02_TIMESTAMP: value = %x ('%c')",
-					  *valueP, *valueP));
+	    case XC02_THRESH_STATE:
+			*valueP = (int32)llHdl->thrState;
 			break;
 
         /*--------------------------+
-        |  TEMP                     |
+        |  shutdown event signal    |
         +--------------------------*/
-	    case XC02_TEMP:
-			SMB_R_BYTE( XC02C_TEMP, &regVal );
+	    case XC02_DOWN_SIG_SUPPR:
+			*valueP = (int32)llHdl->downSuppr;
+			break;
+	    case XC02_DOWN_SIG_PERIOD:
+			*valueP = (int32)llHdl->job[JOB_DOWN].curMsec;
+			break;
+	    case XC02_LOG_PERIOD:
+			*valueP = (int32)llHdl->job[JOB_LOG].msec;
+			break;
+	    case XC02_BR_LEVEL:
+			if( ch >= FADE_NUM )
+				return(ERR_LL_ILL_PARAM);
+			/* derated: report the setpoint, not the cap */
+			if( llHdl->derScreens & llHdl->brUserVld & (1 << ch) )
+				regVal = llHdl->brUser[ch];
+			else if( (error = RegRead( llHdl, G_FadeReg[ch], &regVal )) )
+				break;
+			*valueP = LutInverse( llHdl, regVal );
+			break;
+	    case XC02_BR_EFFECTIVE:
+			if( ch >= FADE_NUM )
+				return(ERR_LL_ILL_PARAM);
+			if( (error = RegRead( llHdl, G_FadeReg[ch], &regVal )) )
+				break;
 			*valueP = (int32)regVal;
-			DBGWRT_2((DBH, " - XC02_TEMP:   value = %x ", *valueP));
 			break;
-
-        /*--------------------------+
-        |  TEMP_HIGH                |
-        +--------------------------*/
-        case XC02_TEMP_HIGH:
-			SMB_R_BYTE( XC02C_TEMP_HIGH, &regVal );
-			*valueP = (int32)XC02_ADC2TEMP(regVal);
-			DBGWRT_2((DBH, " - XC02_TEMP_HIGH:= %d\n", *valueP ));
+	    case XC02_ABR_AMBIENT:
+			*valueP = (int32)((llHdl->abrEwma + 0x80) >> 8);
+			break;
+	    case XC02_TRACE_PERIOD:
+			*valueP = (int32)llHdl->job[JOB_TRACE].msec;
+			break;
+	    case XC02_WDOG_LEASE:
+			*valueP = (int32)llHdl->wdLease;
+			break;
+	    case XC02_WDOG_LEASE_LEFT:
+			*valueP = (int32)WdLeaseLeft( llHdl );
+			break;
+	    case XC02_WDOG_COALESCE:
+			*valueP = (int32)llHdl->wdCoal;
+			break;
+	    case XC02_DERATE_CAP:
+			*valueP = (int32)llHdl->derCapLvl;
+			break;
+	    case XC02_FADE_STATE:
+			*valueP = (llHdl->fade[0].active ? 0x01 : 0) |
+					  (llHdl->fade[1].active ? 0x02 : 0);
 			break;
 
         /*--------------------------+
-        |  TEMP_LOW                 |
+        |  telemetry snapshot       |
         +--------------------------*/
-	    case XC02_TEMP_LOW:
-			SMB_R_BYTE( XC02C_TEMP_LOW, &regVal );
-			*valueP = (int32)( XC02_ADC2TEMP(regVal) );
-			DBGWRT_2((DBH, " - XC02_TEMP_LOW:= %d\n", *valueP ));
-			break;
+	    case XC02_BLK_SNAPSHOT_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
 
+			if( blk->size < sizeof(XC02_BLK_SNAPSHOT) )
+				return(ERR_LL_USERBUF);
 
-        /*--------------------------+
-        |  VOLTAGE                  |
-        +--------------------------*/
-        case XC02_VOLTAGE:
-			SMB_R_BYTE( XC02C_VOLT, &regVal );
-			*valueP = (int32)regVal;
-			DBGWRT_3((DBH, " - XC02_VOLTAGE: value = %x ", *valueP));
+			error = SnapshotGet( llHdl, (XC02_BLK_SNAPSHOT*)blk->data );
+			blk->size = sizeof(XC02_BLK_SNAPSHOT);
 			break;
-
+		}
 
         /*--------------------------+
-        |  VOLT_HIGH                |
+        |  telemetry statistics     |
         +--------------------------*/
-        case XC02_VOLT_HIGH:
-			SMB_R_BYTE( XC02C_VOLT_HIGH, &regVal );
-			*valueP = (int32)XC02_ADC2TEMP(regVal);
-			DBGWRT_2((DBH, " - XC02_TEMP_HIGH:= %d\n", *valueP ));
-			break;
+	    case XC02_BLK_STATS_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
 
+			if( blk->size < sizeof(XC02_BLK_STATS) )
+				return(ERR_LL_USERBUF);
 
-        /*--------------------------+
-        |  VOLT_LOW                 |
-        +--------------------------*/
-	    case XC02_VOLT_LOW:
-			SMB_R_BYTE( XC02C_VOLT_LOW, &regVal );
-			*valueP = (int32)( XC02_ADC2TEMP(regVal) );
-			DBGWRT_2((DBH, " - XC02_TEMP_LOW:= %d\n", *valueP ));
+			StatGet( llHdl, (XC02_BLK_STATS*)blk->data );
+			blk->size = sizeof(XC02_BLK_STATS);
 			break;
-
+		}
 
         /*--------------------------+
-        |  XC02_DISP_INITSTAT       |
+        |  backlight energy         |
         +--------------------------*/
-        case XC02_DISP_INITSTAT:    /* 1: ON, BIOS etc. shown  0: OFF */
-			SMB_R_BYTE( XC02C_INIT_DS, &regVal );
-		    *valueP = (int32)(regVal);
-			DBGWRT_2((DBH, " - XC02_DISP_INITSTAT:= %d\n", *valueP ));
-			break;
+	    case XC02_BLK_ENERGY_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
 
-		/*--------------------------+
-        | initial display brightness|
-        +--------------------------*/
-	    case XC02_INIT_BRIGHT:
-			switch (ch) {
-			case 0:
-				SMB_R_BYTE( XC02C_INIT_BR1, &regVal );
-				*valueP = ((int32)(regVal)) & 0xff;
-				break;
-			case 1:
-				SMB_R_BYTE( XC02C_INIT_BR2, &regVal );
-				*valueP = ((int32)(regVal)) & 0xff;
-				break;
-			default:
-				DBGWRT_ERR((DBH," *** XC02_INIT_BRIGHT: illegal chan. %d\n",
-							ch));
-				error = ERR_LL_ILL_PARAM;
-			}
-			break;
+			if( blk->size < sizeof(XC02_BLK_ENERGY) )
+				return(ERR_LL_USERBUF);
 
-        /*--------------------------+
-        |  brightness source        |
-        +--------------------------*/
-        case XC02_BR_SRC:
-			SMB_R_BYTE( XC02C_BR_SRC, &regVal );
-			*valueP = (int32)(regVal);
-			DBGWRT_2((DBH, " - XC02_BR_SRC: %d\n", *valueP ));
+			EnergyGet( llHdl, (XC02_BLK_ENERGY*)blk->data );
+			blk->size = sizeof(XC02_BLK_ENERGY);
 			break;
+		}
 
         /*--------------------------+
-        |  brightness multiplier    |
+        |  firmware state tracer    |
         +--------------------------*/
-        case XC02_BR_MULT:
-			SMB_R_BYTE( XC02C_AUTO_BR_FAK, &regVal );
-			*valueP = (int32)(regVal);
-			DBGWRT_2((DBH, " - XC02_BR_MULT: %d\n", *valueP ));
-			break;
+	    case XC02_BLK_TRACE_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
 
-        /*--------------------------+
-        |  brightness offset        |
-        +--------------------------*/
-	    case XC02_BR_OFFS:
-			SMB_R_BYTE( XC02C_AUTO_BR_OFFS, &regVal );
-			*valueP = (int32)(regVal);
-			DBGWRT_2((DBH, " - XC02_BR_OFFS: %d\n", *valueP ));
-			break;
+			if( blk->size < sizeof(XC02_BLK_TRACE) )
+				return(ERR_LL_USERBUF);
 
-        /*--------------------------+
-        |  switch display           |
-        +--------------------------*/
-        case XC02_SW_DISP:
-			SMB_R_BYTE( XC02C_SW_DISP, &regVal );
-			*valueP = (int32)(regVal);
-			DBGWRT_2((DBH, " - XC02_SW_DISP:= %d\n", *valueP ));
+			TraceGet( llHdl, (XC02_BLK_TRACE*)blk->data );
+			blk->size = sizeof(XC02_BLK_TRACE);
 			break;
+		}
+	    case XC02_BLK_TRACE_STATS_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
 
-        /*--------------------------+
-        |  WDOG time in ms          |
-        +--------------------------*/
-        case WDOG_TIME:
-			SMB_R_BYTE( XC02C_WDOG_TOUT, &regVal );
-			*valueP = (int32)(regVal * 100);
-			DBGWRT_2((DBH, " - WDOG_TIME:= %d\n", *valueP ));
-            break;
+			if( blk->size < sizeof(XC02_BLK_TRACE_STATS) )
+				return(ERR_LL_USERBUF);
 
-        /*--------------------------+
-        |  WDOG status              |
-        +--------------------------*/
-        case WDOG_STATUS:
-			SMB_R_BYTE( XC02C_WDOG_STATE, valueP );
-			DBGWRT_2((DBH, " - WDOG_STATUS:= %d\n", *valueP ));
-            break;
+			TraceStatGet( llHdl, (XC02_BLK_TRACE_STATS*)blk->data );
+			blk->size = sizeof(XC02_BLK_TRACE_STATS);
+			break;
+		}
 
         /*--------------------------+
-        |  WDOG shot                |
+        |  watchdog counters        |
         +--------------------------*/
-        case WDOG_SHOT:
-			SMB_R_BYTE( XC02C_WDOG_ERR, &regVal );
-			*valueP = (int32)(regVal ? 1 : 0);
-			DBGWRT_2((DBH, " - WDOG_SHOT:= %d\n", *valueP ));
-            break;
+	    case XC02_BLK_WDOG_STATS_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
 
-        /*--------------------------+
-        | brightness 1st display    |
-        +--------------------------*/
-	    case XC02_BRIGHTNESS:
-			SMB_R_BYTE( XC02C_SET_BR, &regVal );
-			*valueP = (int32)(regVal & 0xff);
-			DBGWRT_2((DBH, " - XC02_BRIGHTNESS:= %d\n", *valueP ));
-			break;
+			if( blk->size < sizeof(XC02_BLK_WDOG_STATS) )
+				return(ERR_LL_USERBUF);
 
-        /*--------------------------+
-        | brightness 2nd display    |
-        +--------------------------*/
-	    case XC02_BRIGHTNESS2:
-			SMB_R_BYTE( XC02C_SET_BR_2, &regVal );
-			*valueP = (int32)(regVal & 0xff);
-			DBGWRT_2((DBH, " - XC02_BRIGHTNESS2:= %d\n", *valueP ));
+			WdStatGet( llHdl, (XC02_BLK_WDOG_STATS*)blk->data );
+			blk->size = sizeof(XC02_BLK_WDOG_STATS);
 			break;
+		}
+	    case XC02_BLK_WDOG_STARVED_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
 
-        /*--------------------------+
-        |  minicard slot power      |
-        +--------------------------*/
-	    case XC02_MINICARD_PWR:
-			SMB_R_BYTE( XC02C_SW_MINICARD, &regVal );
-			*valueP = (int32)(regVal & 0xff);
-			DBGWRT_2((DBH, " - XC02_MINICARD_PWR:= %d\n", *valueP ));
-			break;
+			if( blk->size < sizeof(XC02_BLK_WDOG_STARVED) )
+				return(ERR_LL_USERBUF);
 
-        /*--------------------------+
-        |  KEY_IN behavior control  |
-        +--------------------------*/
-	    case XC02_KEY_IN_CTRL:
-			SMB_R_BYTE( SC21C_KEY_CTRL, &regVal );
-			*valueP = (int32)(regVal & 0x01);
-			DBGWRT_2((DBH, " - XC02_KEY_IN_CTRL:= %d\n", *valueP ));
+			WdStarvedGet( llHdl, (XC02_BLK_WDOG_STARVED*)blk->data );
+			blk->size = sizeof(XC02_BLK_WDOG_STARVED);
 			break;
+		}
 
         /*--------------------------+
-        |  read 12V drawn current   |
+        |  input transitions        |
         +--------------------------*/
-	    case SC21_BL_CURRENT:
-			SMB_R_BYTE( SC21C_BL_CURR, &regVal );
-			*valueP = (int32)(regVal &0xff);
-			DBGWRT_2((DBH, " - SC21_BL_CURRENT:= %d\n", *valueP ));
-			break;
+	    case XC02_BLK_IN_EVT_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
 
-        /*--------------------------+
-        |  auto brightness behavior |
-        +--------------------------*/
-	    case XC02_AUTO_BRIGHT_CTRL:
-			SMB_R_BYTE( SC21C_BR_DIR, &regVal );
-			*valueP = (int32)(regVal & 0x01);
-			DBGWRT_2((DBH, " - XC02_AUTO_BRIGHT_CTRL:= %d\n", *valueP ));
+			if( blk->size < sizeof(XC02_BLK_IN_EVT) )
+				return(ERR_LL_USERBUF);
+
+			InEvtGet( llHdl, (XC02_BLK_IN_EVT*)blk->data );
+			blk->size = sizeof(XC02_BLK_IN_EVT);
 			break;
+		}
 
         /*--------------------------+
-        | raw photo ADC value       |
+        |  event log                |
         +--------------------------*/
-	    case XC02_RAW_BRIGHTNESS:
-			SMB_R_BYTE( SC21C_BR_RAW, &regVal );
-			*valueP = (int32)(regVal & 0xff);
-			DBGWRT_2((DBH, " - XC02_RAW_BRIGHTNESS:= %d\n", *valueP ));
+	    case XC02_BLK_LOG_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
+
+			if( blk->size < sizeof(XC02_BLK_LOG) )
+				return(ERR_LL_USERBUF);
+
+			LogGet( llHdl, (XC02_BLK_LOG*)blk->data );
+			blk->size = sizeof(XC02_BLK_LOG);
 			break;
+		}
 
         /*--------------------------+
-        |  Test registers #1..3     |
-		|  (for PIC firmware test)  |
+        |  complete configuration   |
         +--------------------------*/
-        case XC02_TEST1:
-			SMB_R_BYTE( XC02C_TEST1, valueP );
-            break;
-        case XC02_TEST2:
-			SMB_R_BYTE( XC02C_TEST2, valueP );
-            break;
-        case XC02_TEST3:
-			SMB_R_BYTE( XC02C_TEST3, valueP );
-            break;
-        case XC02_TEST4:
-			SMB_R_BYTE( XC02C_TEST4, valueP );
-            break;
+	    case XC02_BLK_CONFIG_GET:
+		{
+			M_SG_BLOCK	*blk = (M_SG_BLOCK*)value32_or_64P;
+
+			if( blk->size < sizeof(XC02_BLK_CONFIG) )
+				return(ERR_LL_USERBUF);
+
+			error = ConfigGet( llHdl, (XC02_BLK_CONFIG*)blk->data );
+			blk->size = sizeof(XC02_BLK_CONFIG);
+			break;
+		}
 
 		/*--------------------------+
-        |  unknown                  |
+        |  register based codes     |
         +--------------------------*/
         default:
-			error = ERR_LL_UNK_CODE;
+		{
+			const REG_DESC *d = RegDescGet( code );
+			u_int32	screen = (code == XC02_BRIGHTNESS2);
+
+			/* derated: report the setpoint, see XC02_BR_EFFECTIVE */
+			if( ((code == XC02_BRIGHTNESS) || (code == XC02_BRIGHTNESS2)) &&
+				(llHdl->derScreens & llHdl->brUserVld & (1 << screen)) )
+				*valueP = (int32)llHdl->brUser[screen];
+			else if( d && (d->acc & ACC_R) )
+				error = RegDescGetStat( llHdl, d, ch, valueP );
+			else
+				error = ERR_LL_UNK_CODE;
+		}
     }
 
 	return(error);
@@ -1328,9 +2119,10 @@ static int32 XC02_GetStat(
 
 
 /******************************* XC02_BlockRead ******************************/
-/** Read a data block from the device
+/** Read records of the telemetry sampler
  *
- *  The function is not supported and always returns an ERR_LL_ILL_FUNC error.
+ *  Removes as many #XC02_SMP_REC records (oldest first) from the sampler
+ *  buffer as fit into the data buffer. Doesn't wait if the buffer is empty.
  *
  *  \param llHdl       \IN  Low-level handle
  *  \param ch          \IN  Current channel
@@ -1348,8 +2140,25 @@ static int32 XC02_BlockRead(
      int32     *nbrRdBytesP
 )
 {
+	XC02_SMP_REC	*rec = (XC02_SMP_REC*)buf;
+	u_int32			n = 0;
+
     DBGWRT_1((DBH, "LL - XC02_BlockRead: ch=%d, size=%d\n",ch,size));
-	return(ERR_LL_ILL_FUNC);
+
+	if( size < (int32)sizeof(XC02_SMP_REC) )
+		return(ERR_LL_USERBUF);
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	while( llHdl->smpCnt && ((n+1)*sizeof(XC02_SMP_REC) <= (u_int32)size) ){
+		rec[n++] = llHdl->smpRing[(llHdl->smpIn - llHdl->smpCnt) &
+								  (SMP_RING_SIZE-1)];
+		llHdl->smpCnt--;
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	*nbrRdBytesP = (int32)(n * sizeof(XC02_SMP_REC));
+
+	return(ERR_SUCCESS);
 }
 
 /****************************** XC02_BlockWrite ******************************/
@@ -1550,6 +2359,8 @@ static int32 Cleanup(
    int32        retCode
 )
 {
+	int32	i;
+
     /*------------------------------+
     |  close handles                |
     +------------------------------*/
@@ -1561,9 +2372,16 @@ static int32 Cleanup(
 	if (llHdl->alarmHdl)
 		OSS_AlarmRemove(llHdl->osHdl, &llHdl->alarmHdl);
 
-	/* clean up signal */
-	if (llHdl->sigHdl)
-		OSS_SigRemove(llHdl->osHdl, &llHdl->sigHdl);
+	/* clean up signals (alarm is removed) */
+	for (i=0; i<SUBSCR_NUM; i++)
+		if (llHdl->subscr[i].sig)
+			OSS_SigRemove(llHdl->osHdl, &llHdl->subscr[i].sig);
+
+	/* clean up sampler ring and spinlock (alarm is removed) */
+	if (llHdl->smpRing)
+		OSS_MemFree(llHdl->osHdl, (int8*)llHdl->smpRing, llHdl->smpRingAlloc);
+	if (llHdl->smpLock)
+		OSS_SpinLockRemove(llHdl->osHdl, &llHdl->smpLock);
 
 	/* clean up debug */
 	DBGEXIT((&DBH));
@@ -1592,17 +2410,2789 @@ static int32 Cleanup(
 static void AlarmHandler(void *arg)
 {
 	LL_HANDLE	*llHdl = (LL_HANDLE*)arg;
-	int32		error;
-	u_int8		status;
+	u_int32		now = OSS_TickGet( llHdl->osHdl );
 
 	DBGWRT_1((DBH,">>> LL - XC02 AlarmHandler:\n"));
 
-	SMB_R_BYTE( XC02C_STATUS, &status );
+	/* one-shot alarm expired, AlarmUpdate() below re-arms it */
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	llHdl->almArmed = 0;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
 
-	if( status & XC02C_STATUS_DOWN_EVT ){
-		OSS_SigSend( llHdl->osHdl, llHdl->sigHdl );
-		DBGWRT_3((DBH, " shutdown event --> send signal\n"));
-	}
+	/* shutdown event poll */
+	if( JobDue( llHdl, JOB_DOWN, now ) )
+		DownCheck( llHdl, now );
+
+	/* telemetry sampler */
+	if( JobDue( llHdl, JOB_SMP, now ) )
+		SmpTake( llHdl, now );
+
+	/* warning thresholds */
+	if( JobDue( llHdl, JOB_THRESH, now ) )
+		ThreshCheck( llHdl );
+
+	/* input changes */
+	if( JobDue( llHdl, JOB_IN, now ) )
+		InCheck( llHdl, now );
+
+	/* event log poll */
+	if( JobDue( llHdl, JOB_LOG, now ) )
+		LogCheck( llHdl );
+
+	/* brightness fades */
+	if( JobDue( llHdl, JOB_FADE, now ) )
+		FadeStep( llHdl, now );
+
+	/* auto brightness */
+	if( JobDue( llHdl, JOB_ABR, now ) )
+		AbrCheck( llHdl );
+
+	/* thermal derating */
+	if( JobDue( llHdl, JOB_DERATE, now ) )
+		DerateCheck( llHdl );
+
+	/* firmware state tracer */
+	if( JobDue( llHdl, JOB_TRACE, now ) )
+		TraceCheck( llHdl, now );
+
+	/* watchdog heartbeat */
+	if( JobDue( llHdl, JOB_WDOG, now ) )
+		WdLeaseCheck( llHdl, now );
+
+	/* no job running anymore */
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	llHdl->almRun = JOB_NUM;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	/* arm for the next deadline, stays off if no job is left */
+	AlarmUpdate( llHdl );
 }
 
+/******************************** ShadowInit ********************************/
+/** Read all configuration registers into the register shadow
+ *
+ *  All registers of VOL_CFG descriptors and the watchdog timeout are
+ *  shadowed. Registers which can't be read are left invalid and will be
+ *  read from the PIC on their first access.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ */
+static void ShadowInit( LL_HANDLE *llHdl )
+{
+	u_int32	i;
+	u_int8	val;
+
+	for( i=0; i<REG_DESC_NUM; i++ ){
+		if( !G_RegDesc[i].acc || (G_RegDesc[i].vol != VOL_CFG) )
+			continue;
+		llHdl->shadowFlg[G_RegDesc[i].cmd] = SHADOW_CFG;
+		/* register pair or one register per display */
+		if( (G_RegDesc[i].conv == CONV_WORD) ||
+			(G_RegDesc[i].conv == CONV_CHAN) )
+			llHdl->shadowFlg[G_RegDesc[i].cmd + 1] = SHADOW_CFG;
+	}
+	llHdl->shadowFlg[XC02C_WDOG_TOUT] = SHADOW_CFG;
+
+	for( i=0; i<SHADOW_SIZE; i++ ){
+		if( (llHdl->shadowFlg[i] & SHADOW_CFG) &&
+			RegRead( llHdl, (u_int8)i, &val ) )
+			DBGWRT_ERR((DBH, " *** ShadowInit: can't read reg 0x%02x\n", i));
+	}
+}
 
+/********************************** RegRead *********************************/
+/** Read a PIC register, served from the shadow for config registers
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param cmd        \IN  PIC register (XC02C_xxx)
+ *  \param valP       \OUT register value
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 RegRead( LL_HANDLE *llHdl, u_int8 cmd, u_int8 *valP )
+{
+	int32	error;
+	u_int8	*flgP = (cmd < SHADOW_SIZE) ? &llHdl->shadowFlg[cmd] : NULL;
+
+	if( flgP && (*flgP & SHADOW_VALID) ){
+		*valP = llHdl->shadow[cmd];
+		return( ERR_SUCCESS );
+	}
+
+	SMB_R_BYTE( cmd, valP );
+	LogSmbErr( llHdl, cmd, error );
+	if( !error && flgP && (*flgP & SHADOW_CFG) ){
+		llHdl->shadow[cmd] = *valP;
+		*flgP |= SHADOW_VALID;
+	}
+
+	return( error );
+}
+
+/********************************* RegWrite *********************************/
+/** Write a PIC register and update its shadow copy
+ *
+ *  On error the shadow entry is invalidated, since the register content is
+ *  unknown then.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param cmd        \IN  PIC register (XC02C_xxx)
+ *  \param val        \IN  value to write
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 RegWrite( LL_HANDLE *llHdl, u_int8 cmd, u_int8 val )
+{
+	int32	error;
+
+	SMB_W_BYTE( cmd, val );
+	LogSmbErr( llHdl, cmd, error );
+
+	if( (cmd < SHADOW_SIZE) && (llHdl->shadowFlg[cmd] & SHADOW_CFG) ){
+		if( error )
+			llHdl->shadowFlg[cmd] &= ~SHADOW_VALID;
+		else {
+			llHdl->shadow[cmd] = val;
+			llHdl->shadowFlg[cmd] |= SHADOW_VALID;
+		}
+	}
+
+	return( error );
+}
+
+/********************************* Reg16Read ********************************/
+/** Read a 16 bit PIC register pair (low byte at cmd, high byte at cmd+1)
+ *
+ *  Served from the shadow if both halves are valid. Otherwise one SMBus
+ *  word transaction is used if available, so that the firmware can't
+ *  change the value between the two halves.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param cmd        \IN  PIC register of low byte (XC02C_xxx_L)
+ *  \param valP       \OUT register pair value
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 Reg16Read( LL_HANDLE *llHdl, u_int8 cmd, u_int16 *valP )
+{
+	int32	error;
+	u_int8	lVal, hVal;
+	u_int8	*flgP = (cmd+1 < SHADOW_SIZE) ? &llHdl->shadowFlg[cmd] : NULL;
+
+	if( !llHdl->wordAcc ||
+		(flgP && (flgP[0] & SHADOW_VALID) && (flgP[1] & SHADOW_VALID)) ){
+		if( (error = RegRead( llHdl, cmd, &lVal )) ||
+			(error = RegRead( llHdl, cmd + 1, &hVal )) )
+			return( error );
+		*valP = (u_int16)(hVal<<8 | lVal);
+		return( ERR_SUCCESS );
+	}
+
+	SMB_R_WORD( cmd, valP );
+	LogSmbErr( llHdl, cmd, error );
+	if( !error && flgP && (flgP[0] & SHADOW_CFG) ){
+		llHdl->shadow[cmd]	 = (u_int8)(*valP & 0xff);
+		llHdl->shadow[cmd+1] = (u_int8)(*valP >> 8);
+		flgP[0] |= SHADOW_VALID;
+		flgP[1] |= SHADOW_VALID;
+	}
+
+	return( error );
+}
+
+/******************************** Reg16Write ********************************/
+/** Write a 16 bit PIC register pair (low byte at cmd, high byte at cmd+1)
+ *
+ *  Uses one SMBus word transaction if available, byte writes otherwise.
+ *  The first word write is read back bytewise; if the firmware mishandled
+ *  it, the value is written as bytes and word access is disabled.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param cmd        \IN  PIC register of low byte (XC02C_xxx_L)
+ *  \param val        \IN  value to write
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 Reg16Write( LL_HANDLE *llHdl, u_int8 cmd, u_int16 val )
+{
+	int32	error;
+	u_int8	*flgP = (cmd+1 < SHADOW_SIZE) ? &llHdl->shadowFlg[cmd] : NULL;
+
+	if( !llHdl->wordAcc ){
+		if( (error = RegWrite( llHdl, cmd, (u_int8)(val & 0xff) )) )
+			return( error );
+		return( RegWrite( llHdl, cmd + 1, (u_int8)(val >> 8) ) );
+	}
+
+	SMB_W_WORD( cmd, val );
+	LogSmbErr( llHdl, cmd, error );
+
+	/* verify first word write */
+	if( !error && !llHdl->wordWrOk ){
+		u_int8	lVal, hVal;
+
+		SMB_R_BYTE( cmd, &lVal );
+		if( !error ){
+			SMB_R_BYTE( cmd + 1, &hVal );
+		}
+		if( !error && ((u_int16)(hVal<<8 | lVal) == val) )
+			llHdl->wordWrOk = 1;
+		else {
+			DBGWRT_ERR((DBH, " *** Reg16Write: word write failed, "
+						"using byte access\n"));
+			llHdl->wordAcc = 0;
+			if( flgP ){
+				flgP[0] &= ~SHADOW_VALID;
+				flgP[1] &= ~SHADOW_VALID;
+			}
+			if( (error = RegWrite( llHdl, cmd, (u_int8)(val & 0xff) )) )
+				return( error );
+			return( RegWrite( llHdl, cmd + 1, (u_int8)(val >> 8) ) );
+		}
+	}
+
+	if( flgP && (flgP[0] & SHADOW_CFG) ){
+		if( error ){
+			flgP[0] &= ~SHADOW_VALID;
+			flgP[1] &= ~SHADOW_VALID;
+		}
+		else {
+			llHdl->shadow[cmd]	 = (u_int8)(val & 0xff);
+			llHdl->shadow[cmd+1] = (u_int8)(val >> 8);
+			flgP[0] |= SHADOW_VALID;
+			flgP[1] |= SHADOW_VALID;
+		}
+	}
+
+	return( error );
+}
+
+/******************************* WordAccProbe *******************************/
+/** Check if the PIC firmware handles SMBus word transactions
+ *
+ *  The WOT register pair is read bytewise, as word and bytewise again.
+ *  The word value must match both byte reads. On any mismatch or error
+ *  word access stays disabled and byte pairs are used. Nothing is written
+ *  here, the first word write is verified by Reg16Write().
+ *
+ *  \param llHdl      \IN  Low-level handle
+ */
+static void WordAccProbe( LL_HANDLE *llHdl )
+{
+	int32	error;
+	u_int8	lVal, hVal;
+	u_int16	wVal, bVal1, bVal2;
+
+	llHdl->wordAcc = 0;
+
+	if( !llHdl->smbH->ReadWordData || !llHdl->smbH->WriteWordData )
+		goto NOWORD;
+
+	SMB_R_BYTE( XC02C_WOT_L, &lVal );
+	if( error )
+		goto NOWORD;
+	SMB_R_BYTE( XC02C_WOT_H, &hVal );
+	if( error )
+		goto NOWORD;
+	bVal1 = (u_int16)(hVal<<8 | lVal);
+
+	SMB_R_WORD( XC02C_WOT_L, &wVal );
+	if( error )
+		goto NOWORD;
+
+	SMB_R_BYTE( XC02C_WOT_L, &lVal );
+	if( error )
+		goto NOWORD;
+	SMB_R_BYTE( XC02C_WOT_H, &hVal );
+	if( error )
+		goto NOWORD;
+	bVal2 = (u_int16)(hVal<<8 | lVal);
+
+	if( (wVal != bVal1) || (wVal != bVal2) )
+		goto NOWORD;
+
+	llHdl->wordAcc	= 1;
+	llHdl->wordWrOk	= 0;
+	DBGWRT_2((DBH, " WordAccProbe: using SMBus word access\n"));
+	return;
+
+NOWORD:
+	DBGWRT_2((DBH, " WordAccProbe: using SMBus byte access\n"));
+}
+
+/******************************* RegBurstRead *******************************/
+/** Read contiguous PIC registers with one combined I2C transfer
+ *
+ *  Sends the start register and reads \a num bytes after a repeated
+ *  start. The register shadow is not used or updated.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param cmd        \IN  first PIC register (XC02C_xxx)
+ *  \param buf        \OUT register values
+ *  \param num        \IN  number of registers (1..BURST_MAX)
+ *
+ *  \return           \c 0 On success or error code,
+ *                    ERR_LL_ILL_FUNC if burst reads are not available
+ */
+static int32 RegBurstRead(
+	LL_HANDLE	*llHdl,
+	u_int8		cmd,
+	u_int8		*buf,
+	u_int32		num )
+{
+	SMB_I2C_MESSAGE	msg[2];
+	int32			error;
+
+	if( !llHdl->burstAcc )
+		return( ERR_LL_ILL_FUNC );
+
+	msg[0].addr	 = llHdl->smbAddr;
+	msg[0].flags = 0;
+	msg[0].len	 = 1;
+	msg[0].buf	 = &cmd;
+
+	msg[1].addr	 = llHdl->smbAddr;
+	msg[1].flags = SMB_I2C_M_RD;
+	msg[1].len	 = (u_int16)num;
+	msg[1].buf	 = buf;
+
+	if( (error = llHdl->smbH->I2CXfer( llHdl->smbH, msg, 2 )) )
+		DBGWRT_ERR((DBH, " *** RegBurstRead: reg 0x%02x len %d error 0x%x\n",
+					cmd, num, error));
+
+	return( error );
+}
+
+/******************************** BurstProbe ********************************/
+/** Check if the bus controller and the PIC firmware support burst reads
+ *
+ *  The SMBus controller must support I2C transfers. A burst of the ID and
+ *  revision registers and a burst of registers XC02C_DOWN_DELAY..XC02C_IN
+ *  must match the byte reads of these registers (config registers are
+ *  compared with the shadow). Only readable registers without side effects
+ *  are probed. On any mismatch or error burst reads stay disabled and all
+ *  registers are read bytewise.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ */
+static void BurstProbe( LL_HANDLE *llHdl )
+{
+	int32	error;
+	u_int8	buf[XC02C_IN+1-BURST_PROBE_REG], id, rev;
+	u_int32	i;
+
+	llHdl->burstAcc = 0;
+	BurstMaskInit( llHdl );
+
+	if( !(llHdl->smbH->Capability & SMB_FUNC_I2C) || !llHdl->smbH->I2CXfer )
+		goto NOBURST;
+
+	SMB_R_BYTE( XC02C_ID, &id );
+	if( error )
+		goto NOBURST;
+	SMB_R_BYTE( XC02C_REV, &rev );
+	if( error )
+		goto NOBURST;
+
+	llHdl->burstAcc = 1;
+
+	/* ID/REV */
+	if( RegBurstRead( llHdl, XC02C_ID, buf, 2 ) ||
+		(buf[0] != id) || (buf[1] != rev) )
+		goto NOBURST;
+
+	/* status block, compare config registers */
+	if( RegBurstRead( llHdl, BURST_PROBE_REG, buf, sizeof(buf) ) )
+		goto NOBURST;
+
+	for( i=0; i<sizeof(buf); i++ ){
+		if( (llHdl->shadowFlg[BURST_PROBE_REG+i] & SHADOW_VALID) &&
+			(buf[i] != llHdl->shadow[BURST_PROBE_REG+i]) )
+			goto NOBURST;
+	}
+
+	DBGWRT_2((DBH, " BurstProbe: using I2C burst reads\n"));
+	return;
+
+NOBURST:
+	llHdl->burstAcc = 0;
+	DBGWRT_2((DBH, " BurstProbe: using SMBus byte reads\n"));
+}
+
+/******************************** SnapshotGet *******************************/
+/** Collect all volatile telemetry registers into a snapshot
+ *
+ *  Fields which could not be read have their XC02_SNAP_xxx flag cleared.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param snap       \OUT snapshot
+ *
+ *  \return           \c 0 if at least one field is valid, or error code
+ */
+static int32 SnapshotGet( LL_HANDLE *llHdl, XC02_BLK_SNAPSHOT *snap )
+{
+	int32	error = ERR_SUCCESS, lastErr = ERR_SUCCESS;
+	u_int32	i, first, last;
+	u_int8	img[SHADOW_SIZE], imgFlg[SHADOW_SIZE];
+
+	OSS_MemFill( llHdl->osHdl, sizeof(*snap), (char*)snap, 0x00 );
+	snap->version	= XC02_SNAPSHOT_VERSION;
+	snap->tick		= OSS_TickGet( llHdl->osHdl );
+	snap->tickRate	= OSS_TickRateGet( llHdl->osHdl );
+
+	/* mark the registers needed */
+	OSS_MemFill( llHdl->osHdl, sizeof(imgFlg), (char*)imgFlg, 0x00 );
+	for( i=0; i<REG_DESC_NUM; i++ ){
+		if( G_RegDesc[i].snap )
+			imgFlg[G_RegDesc[i].cmd] = SHADOW_CFG;
+	}
+
+	/*
+	 * burst read: merge needed registers into runs of max. BURST_MAX
+	 * bytes, allowing max. BURST_GAP unused registers in between; a run
+	 * ends at any register which must not be read by a burst
+	 */
+	for( first=0; llHdl->burstAcc && first<SHADOW_SIZE; first=last+1 ){
+		last = first;
+		if( !imgFlg[first] || !llHdl->burstOk[first] )
+			continue;
+
+		for( i=first+1; (i<SHADOW_SIZE) && (i-first < BURST_MAX) &&
+				 (i-last <= BURST_GAP+1) && llHdl->burstOk[i]; i++ ){
+			if( imgFlg[i] )
+				last = i;
+		}
+
+		if( RegBurstRead( llHdl, (u_int8)first, &img[first],
+						  last-first+1 ) == ERR_SUCCESS ){
+			for( i=first; i<=last; i++ )
+				imgFlg[i] |= SHADOW_VALID;
+		}
+	}
+
+	/* take burst values, read the rest bytewise */
+	for( i=0; i<REG_DESC_NUM; i++ ){
+		if( !G_RegDesc[i].snap )
+			continue;
+		if( imgFlg[G_RegDesc[i].cmd] & SHADOW_VALID )
+			*((u_int8*)snap + G_RegDesc[i].snapOffs) = img[G_RegDesc[i].cmd];
+		else if( (error = RegRead( llHdl, G_RegDesc[i].cmd,
+							  (u_int8*)snap + G_RegDesc[i].snapOffs )) ){
+			lastErr = error;
+			continue;
+		}
+		snap->valid |= G_RegDesc[i].snap;
+	}
+
+	DBGWRT_2((DBH, " - XC02_BLK_SNAPSHOT_GET: valid=0x%04x\n", snap->valid));
+
+	return( snap->valid ? ERR_SUCCESS : lastErr );
+}
+
+/********************************* ConfigGet ********************************/
+/** Collect all configuration registers
+ *
+ *  The values are served from the register shadow, so usually no SMBus
+ *  access is needed.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param cfg        \OUT configuration
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 ConfigGet( LL_HANDLE *llHdl, XC02_BLK_CONFIG *cfg )
+{
+	int32	error;
+	u_int16	wot;
+	u_int8	val;
+
+	OSS_MemFill( llHdl->osHdl, sizeof(*cfg), (char*)cfg, 0x00 );
+	cfg->version = XC02_CONFIG_VERSION;
+
+	if( (error = Reg16Read( llHdl, XC02C_WOT_L, &wot )) )
+		return( error );
+	cfg->wot = (u_int32)wot;
+
+	if( (error = RegRead( llHdl, XC02C_WDOG_TOUT, &val )) )
+		return( error );
+	cfg->wdogTime = (u_int32)val * 100;
+
+	if( (error = RegRead( llHdl, XC02C_TEMP_HIGH, &val )) )
+		return( error );
+	cfg->tempHigh = XC02_ADC2TEMP(val);
+
+	if( (error = RegRead( llHdl, XC02C_TEMP_LOW, &val )) )
+		return( error );
+	cfg->tempLow = XC02_ADC2TEMP(val);
+
+	if( (error = RegRead( llHdl, XC02C_VOLT_HIGH,	 &cfg->voltHigh ))	  ||
+		(error = RegRead( llHdl, XC02C_VOLT_LOW,	 &cfg->voltLow ))	  ||
+		(error = RegRead( llHdl, XC02C_DOWN_DELAY,	 &cfg->downDelay ))	  ||
+		(error = RegRead( llHdl, XC02C_OFF_DELAY,	 &cfg->offDelay ))	  ||
+		(error = RegRead( llHdl, XC02C_BR_SRC,		 &cfg->brSrc ))		  ||
+		(error = RegRead( llHdl, XC02C_AUTO_BR_FAK,	 &cfg->brMult ))	  ||
+		(error = RegRead( llHdl, XC02C_AUTO_BR_OFFS, &cfg->brOffs ))	  ||
+		(error = RegRead( llHdl, XC02C_INIT_DS,		 &cfg->initDispStat ))||
+		(error = RegRead( llHdl, XC02C_INIT_BR1,	 &cfg->initBright[0]))||
+		(error = RegRead( llHdl, XC02C_INIT_BR2,	 &cfg->initBright[1]))||
+		(error = RegRead( llHdl, SC21C_KEY_CTRL,	 &cfg->keyInCtrl ))	  ||
+		(error = RegRead( llHdl, SC21C_BR_DIR,		 &cfg->autoBrightDir))||
+		(error = RegRead( llHdl, XC02C_SW_MINICARD,	 &cfg->minicardPwr )) )
+		return( error );
+
+	cfg->keyInCtrl		&= 0x01;
+	cfg->autoBrightDir	&= 0x01;
+
+	DBGWRT_2((DBH, " - XC02_BLK_CONFIG_GET\n"));
+
+	return( ERR_SUCCESS );
+}
+
+/********************************* DownCheck ********************************/
+/** Poll the shutdown event flag and send the shutdown signal
+ *
+ *  Called from the alarm handler. In level mode the signal is sent on every
+ *  poll while the event flag is set. In edge mode it is only sent when the
+ *  flag becomes set and, if a rearm interval is set, again after each
+ *  rearm interval while it stays set. Polls without signal are counted.
+ *
+ *  In adaptive mode the poll period is set to minMsec on activity (status
+ *  flags set, KEY_IN off or firmware not in SM_STATE_ON) and doubled after
+ *  DOWN_RELAX_POLLS idle polls, up to maxMsec.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param now        \IN  current time [ticks]
+ */
+static void DownCheck( LL_HANDLE *llHdl, u_int32 now )
+{
+	int32	error;
+	u_int8	status, in, state, buf[2];
+	ALM_JOB	*j = &llHdl->job[JOB_DOWN];
+
+	if( llHdl->downMaxMsec ){
+		/* XC02C_STATUS and XC02C_IN are contiguous */
+		if( RegBurstRead( llHdl, XC02C_STATUS, buf, 2 ) == ERR_SUCCESS ){
+			status = buf[0];
+			in	   = buf[1];
+		}
+		else if( RegRead( llHdl, XC02C_STATUS, &status ) ||
+				 RegRead( llHdl, XC02C_IN, &in ) )
+			return;
+		if( RegRead( llHdl, XC02C_TEST4, &state ) )
+			state = SM_STATE_ON;
+
+		if( status || !(in & 0x01) || (state != SM_STATE_ON) ){
+			llHdl->downQuiet = 0;
+			if( j->curMsec != j->msec )
+				JobPeriodSet( llHdl, JOB_DOWN, j->msec, now );
+		}
+		else if( (j->curMsec < llHdl->downMaxMsec) &&
+				 (++llHdl->downQuiet >= DOWN_RELAX_POLLS) ){
+			llHdl->downQuiet = 0;
+			JobPeriodSet( llHdl, JOB_DOWN,
+						  (2*j->curMsec < llHdl->downMaxMsec) ?
+						  2*j->curMsec : llHdl->downMaxMsec, now );
+		}
+	}
+	else {
+		SMB_R_BYTE( XC02C_STATUS, &status );
+		LogSmbErr( llHdl, XC02C_STATUS, error );
+		if( error )
+			return;
+	}
+
+	if( !(status & XC02C_STATUS_DOWN_EVT) ){
+		llHdl->downPend = 0;
+		return;
+	}
+
+	if( !llHdl->downPend )
+		LogAdd( llHdl, XC02_LOG_DOWN, status );
+
+	if( (llHdl->downMode == XC02_DOWN_SIG_EDGE) && llHdl->downPend &&
+		(!llHdl->downRearm ||
+		 ((int32)(now - llHdl->downSigTick) <
+		  (int32)MsecToTicks( llHdl, llHdl->downRearm ))) ){
+		llHdl->downSuppr++;
+		return;
+	}
+
+	llHdl->downPend	   = 1;
+	llHdl->downSigTick = now;
+
+	DBGWRT_3((DBH, " shutdown event --> send signal\n"));
+	EvtSend( llHdl, XC02_EVT_DOWN );
+}
+
+/******************************** MsecToTicks *******************************/
+/** Convert a time in ms to OSS ticks
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param msec       \IN  time [ms]
+ *
+ *  \return           time [ticks]
+ */
+static u_int32 MsecToTicks( LL_HANDLE *llHdl, u_int32 msec )
+{
+	return( (msec / 1000) * llHdl->tickRate +
+			((msec % 1000) * llHdl->tickRate) / 1000 );
+}
+
+/******************************** AlarmUpdate *******************************/
+/** (Re)program the shared one-shot alarm to the next job deadline
+ *
+ *  The alarm is armed for the earliest due time of all active jobs and
+ *  left off if no job is active. An armed alarm is only reprogrammed if
+ *  the new deadline is earlier, a later one is picked up when the handler
+ *  re-arms the alarm after its burst. Each handler run counts as expiry
+ *  of the armed alarm; as this may race with a re-arm from a setstat, the
+ *  alarm is always cleared before it is set. Concurrent calls from the
+ *  handler and from a setstat are serialized, the last caller redoes the
+ *  calculation.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 AlarmUpdate( LL_HANDLE *llHdl )
+{
+	int32	error = ERR_SUCCESS, d, again;
+	u_int32	now, due = 0, msec = 0, ms, realMsec, active, armed, i;
+	ALM_JOB	job[JOB_NUM];
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( llHdl->almBusy ){
+		llHdl->almPend = 1;
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+		return( ERR_SUCCESS );
+	}
+	llHdl->almBusy = 1;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	do {
+		OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+		llHdl->almPend = 0;
+		OSS_MemCopy( llHdl->osHdl, sizeof(job), (char*)llHdl->job,
+					 (char*)job );
+		armed = llHdl->almArmed &&
+			((int32)(llHdl->almDue - OSS_TickGet( llHdl->osHdl )) > 0);
+		due	  = llHdl->almDue;
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+		now		= OSS_TickGet( llHdl->osHdl );
+		active	= FALSE;
+
+		/* earliest deadline, sub-tick periods wait their period */
+		for( i=0; i<JOB_NUM; i++ ){
+			if( !job[i].msec )
+				continue;
+			d = (int32)(job[i].next - now);
+			if( d > 0 ){
+				/* round up, a too early alarm only costs a re-arm */
+				ms = TicksToMsec( llHdl, d );
+				if( MsecToTicks( llHdl, ms ) < (u_int32)d )
+					ms++;
+			}
+			else
+				ms = job[i].curMsec;
+			if( !active || (ms < msec) )
+				msec = ms;
+			active = TRUE;
+		}
+		if( active && !msec )
+			msec = 1;
+
+		/* armed alarm fires early enough ? */
+		if( armed && active &&
+			((int32)(now + MsecToTicks( llHdl, msec ) - due) >= 0) )
+			msec = 0;
+		else if( armed || active ){
+			OSS_AlarmClear( llHdl->osHdl, llHdl->alarmHdl );
+			OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+			llHdl->almArmed = 0;
+			OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+			DBGWRT_3((DBH, " AlarmUpdate: alarm cleared\n"));
+		}
+
+		if( active && msec ){
+			if( (error = OSS_AlarmSet( llHdl->osHdl, llHdl->alarmHdl, msec,
+									   0, &realMsec )) ){
+				DBGWRT_ERR((DBH, " *** AlarmUpdate: can't set alarm %dms\n",
+							msec));
+			}
+			else {
+				OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+				llHdl->almArmed = 1;
+				llHdl->almDue	= now + MsecToTicks( llHdl, realMsec );
+				OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+				DBGWRT_3((DBH, " AlarmUpdate: next burst in %dms\n",
+						  realMsec));
+			}
+		}
+
+		OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+		if( !(again = llHdl->almPend) )
+			llHdl->almBusy = 0;
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+	} while( again );
+
+	return( error );
+}
+
+/********************************* JobStart *********************************/
+/** Start or change a periodic job of the shared alarm
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param job        \IN  job (JOB_xxx)
+ *  \param msec       \IN  period [ms], >0
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 JobStart( LL_HANDLE *llHdl, u_int32 job, u_int32 msec )
+{
+	int32	error;
+	ALM_JOB	*j = &llHdl->job[job];
+	ALM_JOB	old;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	old			= *j;
+	j->next		= OSS_TickGet( llHdl->osHdl ) + MsecToTicks( llHdl, msec );
+	j->msec		= msec;
+	j->curMsec	= msec;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	if( (error = AlarmUpdate( llHdl )) ){
+		OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+		*j = old;
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+	}
+
+	return( error );
+}
+
+/********************************** JobStop *********************************/
+/** Stop a periodic job of the shared alarm
+ *
+ *  If the alarm handler is just running the job, this waits until it
+ *  returned, so the job has no effect after JobStop().
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param job        \IN  job (JOB_xxx)
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 JobStop( LL_HANDLE *llHdl, u_int32 job )
+{
+	u_int32	run;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	llHdl->job[job].msec	= 0;
+	llHdl->job[job].curMsec	= 0;
+	run = llHdl->almRun;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	/* wait for a running instance */
+	while( run == job ){
+		OSS_Delay( llHdl->osHdl, 1 );
+		OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+		run = llHdl->almRun;
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+	}
+
+	return( AlarmUpdate( llHdl ) );
+}
+
+/********************************** JobDue **********************************/
+/** Check if a job is due and schedule its next run
+ *
+ *  Called from the alarm handler. Jobs due within the merge window are
+ *  run in the current handler call instead of waking up the alarm again.
+ *  Their SMBus accesses are still issued one by one. The next due time is advanced by the job period, so
+ *  that the job doesn't drift, unless the job is more than one period
+ *  late. A due job is marked as running until the next JobDue() call or
+ *  the end of the handler, see JobStop().
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param job        \IN  job (JOB_xxx)
+ *  \param now        \IN  current time [ticks]
+ *
+ *  \return           TRUE if job shall run now
+ */
+static int32 JobDue( LL_HANDLE *llHdl, u_int32 job, u_int32 now )
+{
+	ALM_JOB	*j = &llHdl->job[job];
+	u_int32	period;
+	int32	due = FALSE;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( j->msec &&
+		((int32)(now - j->next) >= -(int32)llHdl->almMerge) ){
+		period = MsecToTicks( llHdl, j->curMsec );
+		if( (int32)(now - j->next) > (int32)period )
+			j->next = now + period;
+		else
+			j->next += period;
+		due = TRUE;
+	}
+	llHdl->almRun = due ? job : JOB_NUM;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return( due );
+}
+
+/******************************** JobPeriodSet ******************************/
+/** Change the current period of a running job
+ *
+ *  Called from the alarm handler. The alarm is not reprogrammed here,
+ *  the handler arms it for the next deadline after its burst.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param job        \IN  job (JOB_xxx)
+ *  \param msec       \IN  current period [ms], >= base period
+ *  \param now        \IN  current time [ticks]
+ */
+static void JobPeriodSet(
+	LL_HANDLE	*llHdl,
+	u_int32		job,
+	u_int32		msec,
+	u_int32		now )
+{
+	ALM_JOB	*j = &llHdl->job[job];
+
+	DBGWRT_3((DBH, " job %d: period %dms -> %dms\n", job, j->curMsec, msec));
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( j->msec ){
+		j->curMsec	= msec;
+		j->next		= now + MsecToTicks( llHdl, msec );
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+}
+
+/********************************** SmpTake *********************************/
+/** Take one sample of the telemetry sampler
+ *
+ *  Reads the channels of the sampler mask and appends a record to the
+ *  sampler ring. If the ring is full, the oldest record is overwritten.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param now        \IN  current time [ticks]
+ */
+static void SmpTake( LL_HANDLE *llHdl, u_int32 now )
+{
+	XC02_SMP_REC	rec;
+	u_int32			i;
+
+	OSS_MemFill( llHdl->osHdl, sizeof(rec), (char*)&rec, 0x00 );
+	rec.tick = now;
+
+	for( i=0; i<sizeof(G_SmpChan)/sizeof(G_SmpChan[0]); i++ ){
+		if( (llHdl->smpMask & G_SmpChan[i].flag) &&
+			!RegRead( llHdl, G_SmpChan[i].cmd,
+					  (u_int8*)&rec + G_SmpChan[i].offs ) )
+			rec.valid |= G_SmpChan[i].flag;
+	}
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	StatUpdate( llHdl, &rec );
+	EnergyUpdate( llHdl, &rec );
+	llHdl->smpRing[llHdl->smpIn] = rec;
+	llHdl->smpIn = (llHdl->smpIn + 1) & (SMP_RING_SIZE-1);
+	if( llHdl->smpCnt < SMP_RING_SIZE )
+		llHdl->smpCnt++;
+	else
+		llHdl->smpLost++;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+}
+
+/******************************** StatUpdate ********************************/
+/** Feed a sampler record into the telemetry statistics
+ *
+ *  Called with the sampler spinlock held.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param rec        \IN  sampler record
+ */
+static void StatUpdate( LL_HANDLE *llHdl, XC02_SMP_REC *rec )
+{
+	STAT_CH	*st;
+	u_int32	i, val;
+
+	for( i=0; i<XC02_STAT_CH_NUM; i++ ){
+		if( !(rec->valid & G_StatChan[i].flag) )
+			continue;
+
+		st	= &llHdl->stat[i];
+		val	= *((u_int8*)rec + G_StatChan[i].offs);
+
+		if( st->count == 0 ){
+			st->min = st->max = st->last = (u_int8)val;
+			st->mean = st->ewma = val << 8;
+			st->lastChange = rec->tick;
+		}
+		else {
+			if( val < st->min )
+				st->min = (u_int8)val;
+			if( val > st->max )
+				st->max = (u_int8)val;
+			if( val != st->last ){
+				st->last = (u_int8)val;
+				st->lastChange = rec->tick;
+			}
+			/* signed arithmetic: value may be below the average */
+			st->ewma = (u_int32)((int32)st->ewma +
+				(((int32)(val << 8) - (int32)st->ewma) >> STAT_EWMA_SHIFT));
+			if( st->count < 0xffffffff )
+				st->mean = (u_int32)((int32)st->mean +
+					((int32)(val << 8) - (int32)st->mean) /
+					(int32)(st->count + 1));
+		}
+		st->sum += val;
+		if( st->count < 0xffffffff )
+			st->count++;
+	}
+}
+
+/********************************** StatGet *********************************/
+/** Copy the telemetry statistics, optionally reset them
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param stats      \IN  flags (XC02_STAT_RESET)
+ *                    \OUT statistics
+ */
+static void StatGet( LL_HANDLE *llHdl, XC02_BLK_STATS *stats )
+{
+	u_int32	i, flags = stats->flags;
+
+	OSS_MemFill( llHdl->osHdl, sizeof(*stats), (char*)stats, 0x00 );
+	stats->flags	= flags;
+	stats->tick		= OSS_TickGet( llHdl->osHdl );
+	stats->tickRate	= llHdl->tickRate;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	for( i=0; i<XC02_STAT_CH_NUM; i++ ){
+		stats->ch[i].count		= llHdl->stat[i].count;
+		stats->ch[i].sum		= llHdl->stat[i].sum;
+		stats->ch[i].mean		= llHdl->stat[i].mean;
+		stats->ch[i].ewma		= llHdl->stat[i].ewma;
+		stats->ch[i].lastChange	= llHdl->stat[i].lastChange;
+		stats->ch[i].min		= llHdl->stat[i].min;
+		stats->ch[i].max		= llHdl->stat[i].max;
+		stats->ch[i].last		= llHdl->stat[i].last;
+	}
+	if( flags & XC02_STAT_RESET )
+		OSS_MemFill( llHdl->osHdl, sizeof(llHdl->stat),
+					 (char*)llHdl->stat, 0x00 );
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_2((DBH, " - XC02_BLK_STATS_GET: flags=0x%x\n", flags));
+}
+
+/********************************* ThreshSet ********************************/
+/** Install the warning threshold signal and start monitoring
+ *
+ *  The warning limits must lie within the hard limits (XC02C_TEMP_LOW/HIGH,
+ *  XC02C_VOLT_LOW/HIGH) of the PIC, so that the application is warned
+ *  before the display protection switches the display off.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param thr        \IN  threshold settings
+ *  \param size       \IN  size of settings
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 ThreshSet( LL_HANDLE *llHdl, XC02_BLK_THRESH *thr, int32 size )
+{
+	int32	error;
+	u_int8	val;
+
+	DBGWRT_2((DBH, " - XC02_BLK_THRESH_SET\n"));
+
+	/* check buf size */
+	if( size < (int32)sizeof(XC02_BLK_THRESH) )
+		return(ERR_LL_USERBUF);
+
+	/* already defined ? */
+	if( llHdl->job[JOB_THRESH].msec ){
+		DBGWRT_ERR((DBH, " *** ThreshSet: signal already installed\n"));
+		return(ERR_OSS_SIG_SET);
+	}
+
+	if( (thr->msec == 0) || (thr->mask == 0) ||
+		(thr->mask & ~(XC02_THR_TEMP | XC02_THR_VOLT)) )
+		return(ERR_LL_ILL_PARAM);
+
+	/* check limits against each other and the hard limits */
+	if( thr->mask & XC02_THR_TEMP ){
+		if( (thr->tempLow >= thr->tempHigh) || (thr->tempHyst < 0) )
+			return(ERR_LL_ILL_PARAM);
+		if( !RegRead( llHdl, XC02C_TEMP_HIGH, &val ) &&
+			(thr->tempHigh > XC02_ADC2TEMP(val)) )
+			return(ERR_LL_ILL_PARAM);
+		if( !RegRead( llHdl, XC02C_TEMP_LOW, &val ) &&
+			(thr->tempLow < XC02_ADC2TEMP(val)) )
+			return(ERR_LL_ILL_PARAM);
+	}
+	if( thr->mask & XC02_THR_VOLT ){
+		if( (thr->voltLow >= thr->voltHigh) || (thr->voltHyst < 0) )
+			return(ERR_LL_ILL_PARAM);
+		if( !RegRead( llHdl, XC02C_VOLT_HIGH, &val ) &&
+			(thr->voltHigh > XC02_ADC2VOLT(val)) )
+			return(ERR_LL_ILL_PARAM);
+		if( !RegRead( llHdl, XC02C_VOLT_LOW, &val ) &&
+			(thr->voltLow < XC02_ADC2VOLT(val)) )
+			return(ERR_LL_ILL_PARAM);
+	}
+
+	if( (error = SubscrAdd( llHdl, SUBSCR_THRESH, 0, thr->signal,
+							XC02_EVT_THRESH )) )
+		return(error);
+
+	llHdl->thrMask		= thr->mask;
+	llHdl->thrTempHigh	= thr->tempHigh;
+	llHdl->thrTempLow	= thr->tempLow;
+	llHdl->thrTempHyst	= thr->tempHyst;
+	llHdl->thrVoltHigh	= thr->voltHigh;
+	llHdl->thrVoltLow	= thr->voltLow;
+	llHdl->thrVoltHyst	= thr->voltHyst;
+	llHdl->thrState		= 0;
+
+	if( (error = JobStart( llHdl, JOB_THRESH, thr->msec )) )
+		SubscrDel( llHdl, SUBSCR_THRESH );
+
+	return(error);
+}
+
+/********************************* ThreshClr ********************************/
+/** Stop threshold monitoring and remove its signal
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 ThreshClr( LL_HANDLE *llHdl )
+{
+	int32	error;
+
+	DBGWRT_2((DBH, " - XC02_THRESH_CLR\n"));
+
+	/* not defined ? */
+	if( llHdl->job[JOB_THRESH].msec == 0 ){
+		DBGWRT_ERR((DBH, " *** ThreshClr: signal not installed\n"));
+		return(ERR_OSS_SIG_CLR);
+	}
+
+	if( (error = JobStop( llHdl, JOB_THRESH )) )
+		return(error);
+
+	llHdl->thrState = 0;
+
+	return( SubscrDel( llHdl, SUBSCR_THRESH ) );
+}
+
+/******************************** ThreshCheck *******************************/
+/** Check temperature and voltage against the warning thresholds
+ *
+ *  Called from the alarm handler. The signal is only sent if the
+ *  threshold state changed.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ */
+static void ThreshCheck( LL_HANDLE *llHdl )
+{
+	u_int32	state = llHdl->thrState;
+	u_int8	val;
+
+	if( (llHdl->thrMask & XC02_THR_TEMP) &&
+		!RegRead( llHdl, XC02C_TEMP, &val ) )
+		state = ThreshEval( state, XC02_ADC2TEMP(val), llHdl->thrTempHigh,
+							llHdl->thrTempLow, llHdl->thrTempHyst,
+							XC02_THR_TEMP_HIGH, XC02_THR_TEMP_LOW );
+
+	if( (llHdl->thrMask & XC02_THR_VOLT) &&
+		!RegRead( llHdl, XC02C_VOLT, &val ) )
+		state = ThreshEval( state, XC02_ADC2VOLT(val), llHdl->thrVoltHigh,
+							llHdl->thrVoltLow, llHdl->thrVoltHyst,
+							XC02_THR_VOLT_HIGH, XC02_THR_VOLT_LOW );
+
+	if( state != llHdl->thrState ){
+		DBGWRT_3((DBH, " threshold state 0x%x -> 0x%x --> send signal\n",
+				  llHdl->thrState, state));
+		LogAdd( llHdl, XC02_LOG_THRESH, (llHdl->thrState << 8) | state );
+		llHdl->thrState = state;
+		EvtSend( llHdl, XC02_EVT_THRESH );
+	}
+}
+
+/******************************** ThreshEval ********************************/
+/** Evaluate one channel against its warning thresholds with hysteresis
+ *
+ *  A limit flag is set when the value crosses the limit and cleared when
+ *  the value is back by more than the hysteresis.
+ *
+ *  \param state      \IN  current XC02_THR_xxx state
+ *  \param val        \IN  current value
+ *  \param high       \IN  high limit
+ *  \param low        \IN  low limit
+ *  \param hyst       \IN  hysteresis
+ *  \param highFlag   \IN  state flag for high limit
+ *  \param lowFlag    \IN  state flag for low limit
+ *
+ *  \return           new XC02_THR_xxx state
+ */
+static u_int32 ThreshEval(
+	u_int32	state,
+	int32	val,
+	int32	high,
+	int32	low,
+	int32	hyst,
+	u_int32	highFlag,
+	u_int32	lowFlag )
+{
+	if( val > high )
+		state |= highFlag;
+	else if( val < high - hyst )
+		state &= ~highFlag;
+
+	if( val < low )
+		state |= lowFlag;
+	else if( val > low + hyst )
+		state &= ~lowFlag;
+
+	return( state );
+}
+
+/********************************* InSigSet *********************************/
+/** Install the input change signal and start watching XC02C_IN
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param in         \IN  signal settings
+ *  \param size       \IN  size of settings
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 InSigSet( LL_HANDLE *llHdl, XC02_BLK_IN_SIG *in, int32 size )
+{
+	int32	error;
+	u_int8	val;
+
+	DBGWRT_2((DBH, " - XC02_BLK_IN_SIG_SET\n"));
+
+	/* check buf size */
+	if( size < (int32)sizeof(XC02_BLK_IN_SIG) )
+		return(ERR_LL_USERBUF);
+
+	/* already defined ? */
+	if( llHdl->job[JOB_IN].msec ){
+		DBGWRT_ERR((DBH, " *** InSigSet: signal already installed\n"));
+		return(ERR_OSS_SIG_SET);
+	}
+
+	if( (in->msec == 0) || (in->mask & ~0xff) )
+		return(ERR_LL_ILL_PARAM);
+
+	/* initial value */
+	if( (error = RegRead( llHdl, XC02C_IN, &val )) )
+		return(error);
+
+	if( (error = SubscrAdd( llHdl, SUBSCR_IN, 0, in->signal, XC02_EVT_IN )) )
+		return(error);
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	llHdl->inMask	 = in->mask ? (u_int8)in->mask : 0xff;
+	llHdl->inLast	 = val;
+	llHdl->inEvtCnt	 = 0;
+	llHdl->inEvtLost = 0;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	if( (error = JobStart( llHdl, JOB_IN, in->msec )) )
+		SubscrDel( llHdl, SUBSCR_IN );
+
+	return(error);
+}
+
+/********************************* InSigClr *********************************/
+/** Stop watching XC02C_IN and remove the input change signal
+ *
+ *  Transitions still queued can be read afterwards.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 InSigClr( LL_HANDLE *llHdl )
+{
+	int32	error;
+
+	DBGWRT_2((DBH, " - XC02_IN_SIG_CLR\n"));
+
+	/* not defined ? */
+	if( llHdl->job[JOB_IN].msec == 0 ){
+		DBGWRT_ERR((DBH, " *** InSigClr: signal not installed\n"));
+		return(ERR_OSS_SIG_CLR);
+	}
+
+	if( (error = JobStop( llHdl, JOB_IN )) )
+		return(error);
+
+	return( SubscrDel( llHdl, SUBSCR_IN ) );
+}
+
+/********************************** InCheck *********************************/
+/** Check XC02C_IN for changes of the watched bits
+ *
+ *  Called from the alarm handler. A change is queued and signalled. If the
+ *  queue is full, the oldest transition is overwritten.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param now        \IN  current time [ticks]
+ */
+static void InCheck( LL_HANDLE *llHdl, u_int32 now )
+{
+	IN_EVT	*evt;
+	u_int8	val, old;
+
+	if( RegRead( llHdl, XC02C_IN, &val ) )
+		return;
+
+	/* keep unwatched bits current, old/new are consecutive samples */
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	old = llHdl->inLast;
+	llHdl->inLast = val;
+	if( !((val ^ old) & llHdl->inMask) ){
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+		return;
+	}
+
+	evt = &llHdl->inEvt[llHdl->inEvtIn];
+	evt->tick	= now;
+	evt->oldVal	= old;
+	evt->newVal	= val;
+	llHdl->inEvtIn = (llHdl->inEvtIn + 1) & (IN_EVT_NUM-1);
+	if( llHdl->inEvtCnt < IN_EVT_NUM )
+		llHdl->inEvtCnt++;
+	else
+		llHdl->inEvtLost++;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_3((DBH, " input change 0x%02x -> 0x%02x --> send signal\n",
+			  old, val));
+
+	LogAdd( llHdl, XC02_LOG_IN, (old << 8) | val );
+	EvtSend( llHdl, XC02_EVT_IN );
+}
+
+/********************************** InEvtGet ********************************/
+/** Get and remove all queued input transitions
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param evt        \OUT transitions
+ */
+static void InEvtGet( LL_HANDLE *llHdl, XC02_BLK_IN_EVT *evt )
+{
+	IN_EVT	*e;
+	u_int32	i;
+
+	OSS_MemFill( llHdl->osHdl, sizeof(*evt), (char*)evt, 0x00 );
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	for( i=0; i<llHdl->inEvtCnt; i++ ){
+		e = &llHdl->inEvt[(llHdl->inEvtIn - llHdl->inEvtCnt + i) &
+						  (IN_EVT_NUM-1)];
+		evt->evt[i].tick	= e->tick;
+		evt->evt[i].oldVal	= e->oldVal;
+		evt->evt[i].newVal	= e->newVal;
+	}
+	evt->num  = llHdl->inEvtCnt;
+	evt->lost = llHdl->inEvtLost;
+	llHdl->inEvtCnt	 = 0;
+	llHdl->inEvtLost = 0;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_2((DBH, " - XC02_BLK_IN_EVT_GET: num=%d\n", evt->num));
+}
+
+/********************************* SubscrAdd ********************************/
+/** Fill a subscriber slot
+ *
+ *  The slot is filled under the spinlock, so the alarm handler never sees
+ *  a half installed subscriber.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param slot       \IN  SUBSCR_xxx slot
+ *  \param id         \IN  subscriber id (0 for the legacy slots)
+ *  \param signal     \IN  signal to send, 0: none
+ *  \param evtMask    \IN  XC02_EVT_xxx events of interest
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 SubscrAdd(
+	LL_HANDLE	*llHdl,
+	u_int32		slot,
+	u_int32		id,
+	u_int32		signal,
+	u_int32		evtMask )
+{
+	OSS_SIG_HANDLE	*sig = NULL;
+	int32			error;
+
+	if( signal && (error = OSS_SigCreate( llHdl->osHdl, signal, &sig )) )
+		return(error);
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	llHdl->subscr[slot].id		= id;
+	llHdl->subscr[slot].evtMask	= evtMask;
+	llHdl->subscr[slot].sig		= sig;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return(ERR_SUCCESS);
+}
+
+/********************************* SubscrDel ********************************/
+/** Empty a subscriber slot and remove its signal
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param slot       \IN  SUBSCR_xxx slot
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 SubscrDel( LL_HANDLE *llHdl, u_int32 slot )
+{
+	OSS_SIG_HANDLE	*sig;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	sig = llHdl->subscr[slot].sig;
+	llHdl->subscr[slot].id		= 0;
+	llHdl->subscr[slot].evtMask	= 0;
+	llHdl->subscr[slot].sig		= NULL;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	/* signal is no longer visible to the alarm handler */
+	if( sig )
+		return( OSS_SigRemove( llHdl->osHdl, &sig ) );
+
+	return(ERR_SUCCESS);
+}
+
+/********************************* SubscrFind *******************************/
+/** Find the user slot of a subscriber id
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param id         \IN  subscriber id
+ *
+ *  \return           slot or -1 if not found
+ */
+static int32 SubscrFind( LL_HANDLE *llHdl, u_int32 id )
+{
+	int32	slot;
+
+	for( slot=SUBSCR_USER; slot<SUBSCR_NUM; slot++ )
+		if( llHdl->subscr[slot].evtMask && (llHdl->subscr[slot].id == id) )
+			return( slot );
+
+	return( -1 );
+}
+
+/********************************* Subscribe ********************************/
+/** Add a subscriber for driver events
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param sub        \IN  subscriber settings
+ *  \param size       \IN  size of settings
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 Subscribe( LL_HANDLE *llHdl, XC02_BLK_SUBSCR *sub, int32 size )
+{
+	int32	slot;
+
+	DBGWRT_2((DBH, " - XC02_BLK_SUBSCRIBE: id=0x%x sig=%d evt=0x%x\n",
+			  sub->id, sub->signal, sub->evtMask));
+
+	/* check buf size */
+	if( size < (int32)sizeof(XC02_BLK_SUBSCR) )
+		return(ERR_LL_USERBUF);
+
+	if( (sub->id == 0) || (sub->signal == 0) || (sub->evtMask == 0) ||
+		(sub->evtMask & ~XC02_EVT_ALL) )
+		return(ERR_LL_ILL_PARAM);
+
+	/* id already used ? */
+	if( SubscrFind( llHdl, sub->id ) >= 0 ){
+		DBGWRT_ERR((DBH, " *** Subscribe: id 0x%x already used\n", sub->id));
+		return(ERR_OSS_SIG_SET);
+	}
+
+	/* find free slot */
+	for( slot=SUBSCR_USER; slot<SUBSCR_NUM; slot++ )
+		if( llHdl->subscr[slot].evtMask == 0 )
+			break;
+
+	if( slot == SUBSCR_NUM ){
+		DBGWRT_ERR((DBH, " *** Subscribe: no free subscriber slot\n"));
+		return(ERR_LL_DEV_BUSY);
+	}
+
+	return( SubscrAdd( llHdl, slot, sub->id, sub->signal, sub->evtMask ) );
+}
+
+/******************************** Unsubscribe *******************************/
+/** Remove a subscriber
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param id         \IN  subscriber id
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 Unsubscribe( LL_HANDLE *llHdl, u_int32 id )
+{
+	int32	slot;
+
+	DBGWRT_2((DBH, " - XC02_UNSUBSCRIBE: id=0x%x\n", id));
+
+	if( (slot = SubscrFind( llHdl, id )) < 0 ){
+		DBGWRT_ERR((DBH, " *** Unsubscribe: id 0x%x not found\n", id));
+		return(ERR_OSS_SIG_CLR);
+	}
+
+	return( SubscrDel( llHdl, slot ) );
+}
+
+/********************************** EvtSend *********************************/
+/** Send the signals of all subscribers of an event
+ *
+ *  Called from the alarm handler.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param evt        \IN  XC02_EVT_xxx event
+ */
+static void EvtSend( LL_HANDLE *llHdl, u_int32 evt )
+{
+	SUBSCR	*s;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	for( s=llHdl->subscr; s<&llHdl->subscr[SUBSCR_NUM]; s++ )
+		if( (s->evtMask & evt) && s->sig )
+			OSS_SigSend( llHdl->osHdl, s->sig );
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+}
+
+/********************************** LogAdd **********************************/
+/** Append an event to the event log
+ *
+ *  The oldest entry is overwritten when the log is full. Must not be
+ *  called with the spinlock held.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param type       \IN  XC02_LOG_xxx event type
+ *  \param data       \IN  event data
+ */
+static void LogAdd( LL_HANDLE *llHdl, u_int8 type, u_int32 data )
+{
+	u_int32	now = OSS_TickGet( llHdl->osHdl );
+	LOG_ENT	*ent;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	ent = &llHdl->log[llHdl->logSeq & (LOG_NUM-1)];
+	ent->tick = now;
+	ent->data = data;
+	ent->type = type;
+	llHdl->logSeq++;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+}
+
+/********************************** LogGet **********************************/
+/** Copy event log entries starting at a sequence number
+ *
+ *  The log is not changed, so several collectors can read it with their
+ *  own cursor. If \a log->seq refers to entries which were already
+ *  overwritten, reading starts at the oldest entry and \a log->lost is
+ *  set. A cursor beyond the newest entry (e.g. after a driver restart)
+ *  also restarts at the oldest entry.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param log        \IN  seq: first wanted sequence number
+ *                    \OUT entries, seq: cursor for the next call
+ */
+static void LogGet( LL_HANDLE *llHdl, XC02_BLK_LOG *log )
+{
+	u_int32	seq = log->seq, oldest, n = 0;
+	LOG_ENT	*ent;
+
+	log->lost = 0;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	oldest = (llHdl->logSeq > LOG_NUM) ? llHdl->logSeq - LOG_NUM : 0;
+
+	if( (int32)(seq - llHdl->logSeq) > 0 )
+		seq = oldest;
+	else if( (int32)(seq - oldest) < 0 ){
+		log->lost = oldest - seq;
+		seq = oldest;
+	}
+
+	while( (seq != llHdl->logSeq) && (n < XC02_LOG_MAX) ){
+		ent = &llHdl->log[seq & (LOG_NUM-1)];
+		log->ent[n].seq		= seq;
+		log->ent[n].tick	= ent->tick;
+		log->ent[n].type	= ent->type;
+		log->ent[n].data	= ent->data;
+		n++;
+		seq++;
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	log->num = n;
+	log->seq = seq;
+
+	DBGWRT_2((DBH, " - XC02_BLK_LOG_GET: num=%d lost=%d next=%d\n",
+			  n, log->lost, seq));
+}
+
+/******************************** LogSmbErr *********************************/
+/** Log the first failing SMBus access after a successful one
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param cmd        \IN  PIC register
+ *  \param error      \IN  result of the SMBus access
+ */
+static void LogSmbErr( LL_HANDLE *llHdl, u_int8 cmd, int32 error )
+{
+	if( !error )
+		llHdl->logSmbErr = 0;
+	else if( !llHdl->logSmbErr ){
+		llHdl->logSmbErr = 1;
+		LogAdd( llHdl, XC02_LOG_SMB_ERR,
+				((u_int32)cmd << 16) | ((u_int32)error & 0xffff) );
+	}
+}
+
+/********************************* LogCheck *********************************/
+/** Poll firmware state and watchdog error count for the event log
+ *
+ *  Called from the alarm handler. The first poll after start only takes
+ *  the current values.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ */
+static void LogCheck( LL_HANDLE *llHdl )
+{
+	u_int8	state, wdErr;
+
+	if( RegRead( llHdl, XC02C_TEST4, &state ) ||
+		RegRead( llHdl, XC02C_WDOG_ERR, &wdErr ) )
+		return;
+
+	if( llHdl->logPolled ){
+		if( state != llHdl->logFwState )
+			LogAdd( llHdl, XC02_LOG_FW_STATE,
+					(llHdl->logFwState << 8) | state );
+		if( wdErr != llHdl->logWdErr )
+			LogAdd( llHdl, XC02_LOG_WDOG_MISS,
+					(llHdl->logWdErr << 8) | wdErr );
+	}
+
+	llHdl->logFwState = state;
+	llHdl->logWdErr	  = wdErr;
+	llHdl->logPolled  = 1;
+}
+
+/********************************** JobEnd **********************************/
+/** End a job from the alarm handler
+ *
+ *  Unlike JobStop() the alarm is not reprogrammed here, the handler arms
+ *  it for the remaining jobs after its burst. A job that ends itself this
+ *  way on its first run is a one-shot job.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param job        \IN  job (JOB_xxx)
+ */
+static void JobEnd( LL_HANDLE *llHdl, u_int32 job )
+{
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	llHdl->job[job].msec	= 0;
+	llHdl->job[job].curMsec	= 0;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+}
+
+/********************************** FadeSet *********************************/
+/** Start or retarget a brightness fade
+ *
+ *  The fade always starts at the current brightness, so a running fade
+ *  is retargeted smoothly.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param fd         \IN  fade settings
+ *  \param size       \IN  size of settings
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 FadeSet( LL_HANDLE *llHdl, XC02_BLK_FADE *fd, int32 size )
+{
+	FADE	*f;
+	int32	error;
+	u_int32	run;
+	u_int8	cur, lvl;
+
+	/* check buf size */
+	if( size < (int32)sizeof(XC02_BLK_FADE) )
+		return(ERR_LL_USERBUF);
+
+	DBGWRT_2((DBH, " - XC02_BLK_FADE_SET: screen=%d target=%d %dms curve=%d\n",
+			  fd->screen, fd->target, fd->msec, fd->curve));
+
+	lvl = (fd->curve & XC02_FADE_LEVEL) ? 1 : 0;
+
+	if( (fd->screen >= FADE_NUM) ||
+		(fd->target > (lvl ? BR_LUT_SIZE-1 : BR_MAX)) ||
+		(fd->msec > FADE_MSEC_MAX) ||
+		((fd->curve & ~XC02_FADE_LEVEL) > XC02_FADE_SQUARE) )
+		return(ERR_LL_ILL_PARAM);
+
+	/* start at the setpoint, the register may be derated */
+	if( llHdl->brUserVld & (1 << fd->screen) )
+		cur = llHdl->brUser[fd->screen];
+	else if( (error = RegRead( llHdl, G_FadeReg[fd->screen], &cur )) )
+		return(error);
+	if( lvl )
+		cur = LutInverse( llHdl, cur );
+
+	f = &llHdl->fade[fd->screen];
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	f->start	= OSS_TickGet( llHdl->osHdl );
+	f->ticks	= MsecToTicks( llHdl, fd->msec );
+	f->curve	= (u_int8)(fd->curve & ~XC02_FADE_LEVEL);
+	f->lvl		= lvl;
+	f->from		= cur;
+	f->to		= (u_int8)fd->target;
+	f->last		= cur;
+	f->gen++;
+	f->active	= 1;
+	/* checked together with active, see end of FadeStep() */
+	run			= llHdl->job[JOB_FADE].msec;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	if( !run && (error = JobStart( llHdl, JOB_FADE, FADE_PERIOD )) ){
+		OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+		f->active = 0;
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+	}
+
+	return(error);
+}
+
+/********************************* FadeStop *********************************/
+/** Cancel a brightness fade, the current brightness is kept
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param screen     \IN  screen (0/1)
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 FadeStop( LL_HANDLE *llHdl, u_int32 screen )
+{
+	if( screen >= FADE_NUM )
+		return(ERR_LL_ILL_PARAM);
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	llHdl->fade[screen].gen++;
+	llHdl->fade[screen].active = 0;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return(ERR_SUCCESS);
+}
+
+/********************************* FadeStep *********************************/
+/** Write the next brightness step of all running fades
+ *
+ *  Called from the alarm handler. The level is computed from the elapsed
+ *  time, so late alarms don't stretch the fade. A failed write is
+ *  retried with the next step. Subscribers of XC02_EVT_FADE are signalled
+ *  when a fade has reached its target.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param now        \IN  current time [ticks]
+ */
+static void FadeStep( LL_HANDLE *llHdl, u_int32 now )
+{
+	FADE	fl, *f;
+	u_int32	i, elapsed, ticks, done = 0;
+	int32	level;
+
+	for( i=0; i<FADE_NUM; i++ ){
+		f = &llHdl->fade[i];
+
+		OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+		fl = *f;
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+		if( !fl.active )
+			continue;
+
+		elapsed = now - fl.start;
+		ticks	= fl.ticks;
+		if( (int32)elapsed >= (int32)ticks ){
+			level = fl.to;
+		}
+		else {
+			/* keep elapsed<<8 within 32 bit */
+			while( ticks > 0xffffff ){
+				ticks	>>= 1;
+				elapsed >>= 1;
+			}
+			level = fl.from + ((fl.to - fl.from) *
+				(int32)FadeCurve( fl.curve, (elapsed << 8) / ticks )) / 256;
+		}
+
+		if( (level != fl.last) &&
+			BrWrite( llHdl, i,
+					 fl.lvl ? llHdl->brLut[level] : (u_int8)level ) )
+			continue;
+
+		OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+		/* not retargeted or cancelled in between ? */
+		if( f->gen == fl.gen ){
+			f->last = (u_int8)level;
+			if( level == fl.to ){
+				f->active = 0;
+				done++;
+			}
+		}
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+	}
+
+	if( done ){
+		DBGWRT_3((DBH, " fade done --> send signal\n"));
+		EvtSend( llHdl, XC02_EVT_FADE );
+	}
+
+	/*
+	 * end the job if no fade is left; decided under the same lock as
+	 * FadeSet() checks the job, so a fade started meanwhile is kept
+	 */
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	for( i=0; (i<FADE_NUM) && !llHdl->fade[i].active; i++ )
+		;
+	if( i == FADE_NUM ){
+		llHdl->job[JOB_FADE].msec	 = 0;
+		llHdl->job[JOB_FADE].curMsec = 0;
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+}
+
+/********************************* FadeCurve ********************************/
+/** Map the fade progress to the brightness progress
+ *
+ *  \param curve      \IN  XC02_FADE_xxx curve
+ *  \param x          \IN  elapsed time, 0..256
+ *
+ *  \return           brightness progress, 0..256
+ */
+static u_int32 FadeCurve( u_int32 curve, u_int32 x )
+{
+	switch( curve ){
+		case XC02_FADE_EASE:
+			/* smoothstep 3x^2 - 2x^3 */
+			return( (x * x * (3*256 - 2*x)) >> 16 );
+		case XC02_FADE_SQUARE:
+			return( (x * x) >> 8 );
+		default:
+			return( x );
+	}
+}
+
+/********************************** LutSet **********************************/
+/** Load the brightness lookup table
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param lut        \IN  table
+ *  \param size       \IN  size of table
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 LutSet( LL_HANDLE *llHdl, XC02_BLK_BR_LUT *lut, int32 size )
+{
+	u_int32	i;
+
+	DBGWRT_2((DBH, " - XC02_BLK_BR_LUT_SET\n"));
+
+	/* check buf size */
+	if( size < (int32)sizeof(XC02_BLK_BR_LUT) )
+		return(ERR_LL_USERBUF);
+
+	for( i=0; i<XC02_BR_LUT_SIZE; i++ )
+		if( lut->pwm[i] > BR_MAX )
+			return(ERR_LL_ILL_PARAM);
+
+	for( i=0; i<XC02_BR_LUT_SIZE; i++ )
+		llHdl->brLut[i] = lut->pwm[i];
+
+	return(ERR_SUCCESS);
+}
+
+/******************************** LutInverse ********************************/
+/** Find the logical brightness level of a PWM value
+ *
+ *  The table need not be monotonic, the first level with the closest
+ *  PWM value is returned.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param pwm        \IN  PWM value (XC02C_SET_BR)
+ *
+ *  \return           logical level 0..255
+ */
+static u_int8 LutInverse( LL_HANDLE *llHdl, u_int8 pwm )
+{
+	u_int32	i, best = 0;
+	int32	diff, bestDiff = 0x100;
+
+	for( i=0; i<XC02_BR_LUT_SIZE; i++ ){
+		diff = llHdl->brLut[i] - pwm;
+		if( diff < 0 )
+			diff = -diff;
+		if( diff < bestDiff ){
+			bestDiff = diff;
+			best	 = i;
+			if( !diff )
+				break;
+		}
+	}
+
+	return( (u_int8)best );
+}
+
+/********************************** AbrSet **********************************/
+/** Start or reconfigure the auto-brightness controller
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param abr        \IN  controller settings
+ *  \param size       \IN  size of settings
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 AbrSet( LL_HANDLE *llHdl, XC02_BLK_ABR *abr, int32 size )
+{
+	u_int32	i;
+
+	/* check buf size */
+	if( size < (int32)sizeof(XC02_BLK_ABR) )
+		return(ERR_LL_USERBUF);
+
+	DBGWRT_2((DBH, " - XC02_BLK_ABR_SET: %dms screens=0x%x deadband=%d "
+			  "num=%d\n", abr->msec, abr->screens, abr->deadband, abr->num));
+
+	if( (abr->msec < ABR_PERIOD_MIN) || (abr->screens == 0) ||
+		(abr->screens & ~((1<<FADE_NUM)-1)) ||
+		(abr->deadband >= BR_LUT_SIZE) ||
+		(abr->num < 2) || (abr->num > ABR_PTS) )
+		return(ERR_LL_ILL_PARAM);
+
+	/* ambient values must be ascending */
+	for( i=1; i<abr->num; i++ )
+		if( abr->pt[i].raw <= abr->pt[i-1].raw )
+			return(ERR_LL_ILL_PARAM);
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	for( i=0; i<abr->num; i++ ){
+		llHdl->abrRaw[i] = abr->pt[i].raw;
+		llHdl->abrLvl[i] = abr->pt[i].level;
+	}
+	llHdl->abrNum		= abr->num;
+	llHdl->abrScreens	= abr->screens;
+	llHdl->abrDeadband	= abr->deadband;
+	llHdl->abrOut		= -1;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	/* (re)start with a fresh filter */
+	if( !llHdl->job[JOB_ABR].msec )
+		llHdl->abrWinCnt = 0;
+
+	return( JobStart( llHdl, JOB_ABR, abr->msec ) );
+}
+
+/********************************** AbrStop *********************************/
+/** Stop the auto-brightness controller, the brightness is kept
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 AbrStop( LL_HANDLE *llHdl )
+{
+	DBGWRT_2((DBH, " - XC02_ABR_STOP\n"));
+
+	return( JobStop( llHdl, JOB_ABR ) );
+}
+
+/********************************* AbrCheck *********************************/
+/** Sample the photo sensor and adjust the brightness
+ *
+ *  Called from the alarm handler. The raw value is filtered by a median
+ *  of the last ABR_MEDIAN samples followed by an EWMA, then mapped by
+ *  the ambient curve to a logical level. The brightness registers are
+ *  only written if the level moved by more than the deadband. Screens
+ *  with a running fade are skipped.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ */
+static void AbrCheck( LL_HANDLE *llHdl )
+{
+	u_int32	i, j, screens, amb;
+	int32	out, diff;
+	u_int8	raw, win[ABR_MEDIAN], tmp;
+
+	if( RegRead( llHdl, SC21C_BR_RAW, &raw ) )
+		return;
+
+	/* median of the last samples, window is primed with the first one */
+	if( !llHdl->abrWinCnt ){
+		for( i=0; i<ABR_MEDIAN; i++ )
+			llHdl->abrWin[i] = raw;
+		llHdl->abrEwma	 = (u_int32)raw << 8;
+		llHdl->abrWinCnt = 1;
+	}
+	llHdl->abrWin[llHdl->abrWinIdx] = raw;
+	llHdl->abrWinIdx = (llHdl->abrWinIdx + 1) % ABR_MEDIAN;
+
+	for( i=0; i<ABR_MEDIAN; i++ )
+		win[i] = llHdl->abrWin[i];
+	for( i=1; i<ABR_MEDIAN; i++ )
+		for( j=i; j && (win[j-1] > win[j]); j-- ){
+			tmp		 = win[j];
+			win[j]	 = win[j-1];
+			win[j-1] = tmp;
+		}
+
+	/* EWMA [ADC * 256] */
+	llHdl->abrEwma += (int32)(((u_int32)win[ABR_MEDIAN/2] << 8) -
+							  llHdl->abrEwma) >> ABR_EWMA_SHIFT;
+	amb = (llHdl->abrEwma + 0x80) >> 8;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	/* piecewise-linear ambient curve */
+	out = CurveMap( amb, llHdl->abrRaw, llHdl->abrLvl, llHdl->abrNum );
+
+	diff = out - llHdl->abrOut;
+	if( (llHdl->abrOut >= 0) && (diff <= (int32)llHdl->abrDeadband) &&
+		(-diff <= (int32)llHdl->abrDeadband) ){
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+		return;
+	}
+	screens = llHdl->abrScreens;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_3((DBH, " auto brightness: ambient=%d level %d -> %d\n",
+			  amb, llHdl->abrOut, out));
+
+	for( i=0; i<FADE_NUM; i++ ){
+		if( !(screens & (1<<i)) || llHdl->fade[i].active )
+			continue;
+		if( BrWrite( llHdl, i, llHdl->brLut[out] ) )
+			return;
+	}
+	llHdl->abrOut = out;
+}
+
+/********************************* CurveMap *********************************/
+/** Map a value by a piecewise-linear curve
+ *
+ *  Outside the curve the value of the nearest point is returned.
+ *
+ *  \param x          \IN  value to map
+ *  \param xs         \IN  x values of the points, strictly ascending
+ *  \param ys         \IN  y values of the points
+ *  \param num        \IN  number of points, >= 2
+ *
+ *  \return           mapped value
+ */
+static int32 CurveMap(
+	int32			x,
+	const u_int8	*xs,
+	const u_int8	*ys,
+	u_int32			num )
+{
+	u_int32	i;
+
+	if( x <= xs[0] )
+		return( ys[0] );
+	if( x >= xs[num-1] )
+		return( ys[num-1] );
+
+	for( i=1; x > xs[i]; i++ )
+		;
+
+	return( ys[i-1] + ((int32)(ys[i] - ys[i-1]) * (x - xs[i-1])) /
+			(int32)(xs[i] - xs[i-1]) );
+}
+
+/********************************** BrWrite *********************************/
+/** Write the brightness of a screen, limited by the thermal derating
+ *
+ *  All brightness changes of the driver pass here. The requested value is
+ *  kept as setpoint, so that it can be restored when the derating ends.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param screen     \IN  screen (0/1)
+ *  \param pwm        \IN  brightness register value, 0 is brightest
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 BrWrite( LL_HANDLE *llHdl, u_int32 screen, u_int8 pwm )
+{
+	llHdl->brUser[screen] = pwm;
+	llHdl->brUserVld	 |= 1 << screen;
+
+	/* a larger value is darker */
+	if( (llHdl->derScreens & (1 << screen)) && (pwm < llHdl->derCapPwm) )
+		pwm = llHdl->derCapPwm;
+
+	return( RegWrite( llHdl, G_FadeReg[screen], pwm ) );
+}
+
+/********************************* DerateSet ********************************/
+/** Start or reconfigure the thermal brightness derating
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param der        \IN  derating settings
+ *  \param size       \IN  size of settings
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 DerateSet( LL_HANDLE *llHdl, XC02_BLK_DERATE *der, int32 size )
+{
+	u_int32	i;
+
+	/* check buf size */
+	if( size < (int32)sizeof(XC02_BLK_DERATE) )
+		return(ERR_LL_USERBUF);
+
+	DBGWRT_2((DBH, " - XC02_BLK_DERATE_SET: %dms screens=0x%x hyst=%d "
+			  "num=%d\n", der->msec, der->screens, der->hyst, der->num));
+
+	if( (der->msec < DER_PERIOD_MIN) || (der->screens == 0) ||
+		(der->screens & ~((1<<FADE_NUM)-1)) || (der->hyst > 50) ||
+		(der->num < 2) || (der->num > DER_PTS) )
+		return(ERR_LL_ILL_PARAM);
+
+	/* distances must be ascending */
+	for( i=1; i<der->num; i++ )
+		if( der->pt[i].delta <= der->pt[i-1].delta )
+			return(ERR_LL_ILL_PARAM);
+
+	/* stop a running derating first, so the new curve starts uncapped */
+	if( llHdl->job[JOB_DERATE].msec )
+		DerateStop( llHdl );
+
+	for( i=0; i<der->num; i++ ){
+		llHdl->derDelta[i] = der->pt[i].delta;
+		llHdl->derLvl[i]   = der->pt[i].level;
+	}
+	llHdl->derNum	  = der->num;
+	llHdl->derHyst	  = der->hyst;
+	llHdl->derTempVld = 0;
+	llHdl->derCapLvl  = BR_LUT_SIZE-1;
+	llHdl->derCapPwm  = 0;
+	llHdl->derScreens = der->screens;
+
+	return( JobStart( llHdl, JOB_DERATE, der->msec ) );
+}
+
+/******************************** DerateStop ********************************/
+/** Stop the thermal brightness derating and restore the setpoints
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 DerateStop( LL_HANDLE *llHdl )
+{
+	int32	error;
+	u_int32	i, screens = llHdl->derScreens;
+
+	DBGWRT_2((DBH, " - XC02_DERATE_STOP\n"));
+
+	if( (error = JobStop( llHdl, JOB_DERATE )) )
+		return(error);
+
+	llHdl->derScreens = 0;
+	llHdl->derCapLvl  = BR_LUT_SIZE-1;
+	llHdl->derCapPwm  = 0;
+
+	for( i=0; i<FADE_NUM; i++ )
+		if( (screens & llHdl->brUserVld & (1 << i)) &&
+			(error = RegWrite( llHdl, G_FadeReg[i], llHdl->brUser[i] )) )
+			break;
+
+	return(error);
+}
+
+/******************************** DerateCheck *******************************/
+/** Limit the brightness according to the panel temperature
+ *
+ *  Called from the alarm handler. The temperature is compared with the
+ *  display protection limit XC02C_TEMP_HIGH. The temperature used for
+ *  the curve follows rises at once, but falls only when the panel cooled
+ *  down by more than the hysteresis, so the cap doesn't toggle. On a new
+ *  cap the screens are set to the darker of setpoint and cap.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ */
+static void DerateCheck( LL_HANDLE *llHdl )
+{
+	u_int32	i, capLvl;
+	int32	temp, delta;
+	u_int8	val, high, pwm;
+
+	if( RegRead( llHdl, XC02C_TEMP, &val ) ||
+		RegRead( llHdl, XC02C_TEMP_HIGH, &high ) )
+		return;
+
+	temp = XC02_ADC2TEMP(val);
+	if( !llHdl->derTempVld || (temp > llHdl->derTemp) )
+		llHdl->derTemp = temp;
+	else if( temp < llHdl->derTemp - (int32)llHdl->derHyst )
+		llHdl->derTemp = temp + llHdl->derHyst;
+	llHdl->derTempVld = 1;
+
+	delta = XC02_ADC2TEMP(high) - llHdl->derTemp;
+	if( delta < 0 )
+		delta = 0;
+	capLvl = CurveMap( delta, llHdl->derDelta, llHdl->derLvl, llHdl->derNum );
+
+	if( capLvl == llHdl->derCapLvl )
+		return;
+
+	DBGWRT_3((DBH, " derating: temp=%d high=%d cap %d -> %d\n",
+			  temp, XC02_ADC2TEMP(high), llHdl->derCapLvl, capLvl));
+	LogAdd( llHdl, XC02_LOG_DERATE, (llHdl->derCapLvl << 8) | capLvl );
+
+	llHdl->derCapLvl = capLvl;
+	llHdl->derCapPwm = (capLvl >= BR_LUT_SIZE-1) ? 0 : llHdl->brLut[capLvl];
+
+	for( i=0; i<FADE_NUM; i++ ){
+		if( !(llHdl->derScreens & (1 << i)) )
+			continue;
+		/* setpoint not known yet: take the current value */
+		if( !(llHdl->brUserVld & (1 << i)) ){
+			if( RegRead( llHdl, G_FadeReg[i], &llHdl->brUser[i] ) )
+				continue;
+			llHdl->brUserVld |= 1 << i;
+		}
+		pwm = llHdl->brUser[i];
+		if( pwm < llHdl->derCapPwm )
+			pwm = llHdl->derCapPwm;
+		RegWrite( llHdl, G_FadeReg[i], pwm );
+	}
+}
+
+/******************************** TicksToMsec *******************************/
+/** Convert a time in OSS ticks to ms
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param ticks      \IN  time [ticks]
+ *
+ *  \return           time [ms]
+ */
+static u_int32 TicksToMsec( LL_HANDLE *llHdl, u_int32 ticks )
+{
+	return( (ticks / llHdl->tickRate) * 1000 +
+			((ticks % llHdl->tickRate) * 1000) / llHdl->tickRate );
+}
+
+/******************************* EnergyUpdate *******************************/
+/** Integrate the backlight power of a sampler record
+ *
+ *  Called with the sampler spinlock held. The power of the previous
+ *  sample is integrated over the time since then. After a gap (sampler
+ *  stopped, invalid readings) integration restarts with the next sample.
+ *  0xff (no SC21) is not a valid reading.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param rec        \IN  sampler record
+ */
+static void EnergyUpdate( LL_HANDLE *llHdl, XC02_SMP_REC *rec )
+{
+	u_int32	mw, dt, add;
+
+	if( !(rec->valid & XC02_SNAP_BL_CURR) || (rec->blCurr == 0xff) ){
+		llHdl->enPrevVld = 0;
+		return;
+	}
+
+	mw = SC21_ADC2MW( rec->blCurr );
+
+	if( llHdl->enPrevVld ){
+		dt = TicksToMsec( llHdl, rec->tick - llHdl->enPrevTick );
+		if( (dt <= 2 * llHdl->job[JOB_SMP].msec) && (dt <= ENERGY_DT_MAX) ){
+			/* mWs = mW * ms / 1000, keep the remainder */
+			add = llHdl->enPrevMw * (dt / 1000);
+			llHdl->enRem += llHdl->enPrevMw * (dt % 1000);
+			add += llHdl->enRem / 1000;
+			llHdl->enRem %= 1000;
+
+			llHdl->enLo += add;
+			if( llHdl->enLo < add )
+				llHdl->enHi++;
+		}
+	}
+
+	if( mw > llHdl->enPeak )
+		llHdl->enPeak = mw;
+
+	llHdl->enPrevMw	  = mw;
+	llHdl->enPrevTick = rec->tick;
+	llHdl->enPrevVld  = 1;
+}
+
+/********************************* EnergyGet ********************************/
+/** Copy the backlight energy counter, optionally reset it
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param en         \IN  flags: XC02_ENERGY_RESET
+ *                    \OUT energy counter
+ */
+static void EnergyGet( LL_HANDLE *llHdl, XC02_BLK_ENERGY *en )
+{
+	u_int32	flags = en->flags;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	en->mwsLo	= llHdl->enLo;
+	en->mwsHi	= llHdl->enHi;
+	en->peakMw	= llHdl->enPeak;
+	en->lastMw	= llHdl->enPrevVld ? llHdl->enPrevMw : 0;
+	en->since	= llHdl->enSince;
+	if( flags & XC02_ENERGY_RESET ){
+		llHdl->enLo	   = 0;
+		llHdl->enHi	   = 0;
+		llHdl->enRem   = 0;
+		llHdl->enPeak  = 0;
+		llHdl->enSince = OSS_TickGet( llHdl->osHdl );
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_2((DBH, " - XC02_BLK_ENERGY_GET: flags=0x%x\n", flags));
+}
+
+/******************************** TraceCheck ********************************/
+/** Sample the firmware state for the tracer
+ *
+ *  Called from the alarm handler. Only transitions are queued, the dwell
+ *  time of the left state is added to its statistics. The first sample
+ *  after start only takes the current state.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param now        \IN  current time [ticks]
+ */
+static void TraceCheck( LL_HANDLE *llHdl, u_int32 now )
+{
+	TRC_EVT	*evt;
+	TRC_ST	*st;
+	u_int32	dwell;
+	u_int8	state;
+
+	if( RegRead( llHdl, XC02C_TEST4, &state ) )
+		return;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( !llHdl->trcVld ){
+		llHdl->trcState	= state;
+		llHdl->trcEnter	= now;
+		llHdl->trcVld	= 1;
+	}
+	else if( state != llHdl->trcState ){
+		evt = &llHdl->trcEvt[llHdl->trcIn];
+		evt->tick	= now;
+		evt->from	= llHdl->trcState;
+		evt->to		= state;
+		llHdl->trcIn = (llHdl->trcIn + 1) & (TRC_EVT_NUM-1);
+		if( llHdl->trcCnt < TRC_EVT_NUM )
+			llHdl->trcCnt++;
+		else
+			llHdl->trcLost++;
+
+		if( llHdl->trcState < TRC_ST_NUM ){
+			st	  = &llHdl->trcSt[llHdl->trcState];
+			dwell = TicksToMsec( llHdl, now - llHdl->trcEnter );
+			if( !st->count || (dwell < st->minMsec) )
+				st->minMsec = dwell;
+			if( dwell > st->maxMsec )
+				st->maxMsec = dwell;
+			st->sumMsec	+= dwell;
+			st->count++;
+		}
+		llHdl->trcState	= state;
+		llHdl->trcEnter	= now;
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+}
+
+/********************************* TraceGet ********************************/
+/** Get and remove all queued firmware state transitions
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param trc        \OUT transitions
+ */
+static void TraceGet( LL_HANDLE *llHdl, XC02_BLK_TRACE *trc )
+{
+	TRC_EVT	*evt;
+	u_int32	n = 0;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	while( llHdl->trcCnt ){
+		evt = &llHdl->trcEvt[(llHdl->trcIn - llHdl->trcCnt) &
+							 (TRC_EVT_NUM-1)];
+		trc->evt[n].tick	= evt->tick;
+		trc->evt[n].from	= evt->from;
+		trc->evt[n].to		= evt->to;
+		trc->evt[n]._rsvd[0] = trc->evt[n]._rsvd[1] = 0;
+		llHdl->trcCnt--;
+		n++;
+	}
+	trc->num  = n;
+	trc->lost = llHdl->trcLost;
+	llHdl->trcLost = 0;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_2((DBH, " - XC02_BLK_TRACE_GET: num=%d lost=%d\n", n, trc->lost));
+}
+
+/******************************* TraceStatGet *******************************/
+/** Copy the dwell time statistics of the tracer, optionally reset them
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param ts         \IN  flags: XC02_TRACE_RESET
+ *                    \OUT statistics
+ */
+static void TraceStatGet( LL_HANDLE *llHdl, XC02_BLK_TRACE_STATS *ts )
+{
+	u_int32	i, flags = ts->flags;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	for( i=0; i<TRC_ST_NUM; i++ ){
+		ts->st[i].count		= llHdl->trcSt[i].count;
+		ts->st[i].minMsec	= llHdl->trcSt[i].minMsec;
+		ts->st[i].maxMsec	= llHdl->trcSt[i].maxMsec;
+		ts->st[i].sumMsec	= llHdl->trcSt[i].sumMsec;
+	}
+	ts->state	 = llHdl->trcVld ? llHdl->trcState : 0xffffffff;
+	ts->curMsec	 = llHdl->trcVld ?
+		TicksToMsec( llHdl, OSS_TickGet( llHdl->osHdl ) - llHdl->trcEnter ) : 0;
+	if( flags & XC02_TRACE_RESET )
+		OSS_MemFill( llHdl->osHdl, sizeof(llHdl->trcSt),
+					 (char*)llHdl->trcSt, 0x00 );
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_2((DBH, " - XC02_BLK_TRACE_STATS_GET: flags=0x%x\n", flags));
+}
+
+/********************************* WdTrigger ********************************/
+/** Write one trigger to the watchdog, unless it can be coalesced
+ *
+ *  With coalescing enabled, a trigger is skipped if the last issued one
+ *  is younger than WDOG_TIME/#wdCoal. The watchdog then expires at most
+ *  this interval earlier than with the skipped trigger written.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 WdTrigger( LL_HANDLE *llHdl )
+{
+	int32	error;
+	u_int32	now, minTicks;
+
+	minTicks = MsecToTicks( llHdl, WdCoalMsec( llHdl ) );
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	now = OSS_TickGet( llHdl->osHdl );
+	if( minTicks && llHdl->wdTrigVld &&
+		((now - llHdl->wdTrigTick) < minTicks) ){
+		llHdl->wdCoalesced++;
+		OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+		DBGWRT_3((DBH, " - XC02_WDOG_TRIG coalesced\n" ));
+		return( ERR_SUCCESS );
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_2((DBH, " - XC02_WDOG_TRIG\n" ));
+	error = RegWrite( llHdl, XC02C_WDOG_TRIG, XC02C_FLAG );
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( error )
+		llHdl->wdFailed++;
+	else {
+		llHdl->wdIssued++;
+		llHdl->wdTrigTick = now;
+		llHdl->wdTrigVld  = 1;
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return( error );
+}
+
+/******************************** WdLeaseUpdate *****************************/
+/** Start or stop the watchdog heartbeat job
+ *
+ *  The heartbeat runs while a lease or a client is configured, the
+ *  watchdog is enabled and nothing has lapsed. It triggers at a third of
+ *  the programmed watchdog timeout.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 WdLeaseUpdate( LL_HANDLE *llHdl )
+{
+	int32	error;
+	u_int8	tout;
+
+	if( (!llHdl->wdLease && !llHdl->wdCliNum) || !llHdl->wdState ||
+		llHdl->wdLapsed )
+		return( JobStop( llHdl, JOB_WDOG ) );
+
+	if( (error = RegRead( llHdl, XC02C_WDOG_TOUT, &tout )) )
+		return( error );
+
+	DBGWRT_2((DBH, " WdLeaseUpdate: lease %dms, %d clients, trigger every "
+			  "%dms\n", llHdl->wdLease, llHdl->wdCliNum, tout*100/3));
+
+	return( JobStart( llHdl, JOB_WDOG, tout*100/3 ) );
+}
+
+/********************************* WdRestart ********************************/
+/** Clear a lapse and renew the lease and all client deadlines
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 WdRestart( LL_HANDLE *llHdl )
+{
+	u_int32	now, i;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	now = OSS_TickGet( llHdl->osHdl );
+	llHdl->wdLapsed	  = 0;
+	llHdl->wdLeaseEnd = now + MsecToTicks( llHdl, llHdl->wdLease );
+	for( i=0; i<WD_CLI_NUM; i++ )
+		llHdl->wdCli[i].end = now +
+			MsecToTicks( llHdl, llHdl->wdCli[i].deadline );
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return( WdLeaseUpdate( llHdl ) );
+}
+
+/******************************** WdLeaseRenew ******************************/
+/** Renew the watchdog lease
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           \c 0 On success or ERR_LL_DEV_NOTRDY if lapsed
+ */
+static int32 WdLeaseRenew( LL_HANDLE *llHdl )
+{
+	int32	error = ERR_SUCCESS;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( llHdl->wdLapsed )
+		error = ERR_LL_DEV_NOTRDY;
+	else
+		llHdl->wdLeaseEnd = OSS_TickGet( llHdl->osHdl ) +
+			MsecToTicks( llHdl, llHdl->wdLease );
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return( error );
+}
+
+/******************************** WdLeaseCheck ******************************/
+/** Trigger the watchdog while the lease and all clients are alive
+ *
+ *  Called from the alarm handler. Once the lease or a client deadline
+ *  lapsed, the heartbeat ends and the hardware watchdog expires as
+ *  without driver help. The culprit is kept for #XC02_BLK_WDOG_STARVED_GET.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param now        \IN  current time [ticks]
+ */
+static void WdLeaseCheck( LL_HANDLE *llHdl, u_int32 now )
+{
+	WD_CLI	*cli = NULL;
+	u_int32	lapsed, i;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( !llHdl->wdLapsed ){
+		if( llHdl->wdLease && ((int32)(now - llHdl->wdLeaseEnd) >= 0) ){
+			llHdl->wdLapsed	 = 1;
+			llHdl->wdStarved.id		  = XC02_WDOG_ID_LEASE;
+			llHdl->wdStarved.deadline = llHdl->wdLease;
+			llHdl->wdStarved.name[0]  = '\0';
+		}
+		for( i=0; !llHdl->wdLapsed && (i<WD_CLI_NUM); i++ ){
+			cli = &llHdl->wdCli[i];
+			if( cli->id && ((int32)(now - cli->end) >= 0) ){
+				llHdl->wdLapsed	 = 1;
+				llHdl->wdStarved = *cli;
+			}
+		}
+		if( llHdl->wdLapsed )
+			llHdl->wdStarved.end = now;
+	}
+	/* end the heartbeat here, a WdRestart() may follow right away */
+	if( (lapsed = llHdl->wdLapsed) ){
+		llHdl->job[JOB_WDOG].msec	 = 0;
+		llHdl->job[JOB_WDOG].curMsec = 0;
+	}
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	if( lapsed ){
+		DBGWRT_ERR((DBH, " *** XC02 watchdog starved by 0x%x, stop "
+					"triggering\n", llHdl->wdStarved.id));
+		if( llHdl->wdStarved.id == XC02_WDOG_ID_LEASE )
+			LogAdd( llHdl, XC02_LOG_WDOG_LAPSE, llHdl->wdLease );
+		else
+			LogAdd( llHdl, XC02_LOG_WDOG_STARVE, llHdl->wdStarved.id );
+		return;
+	}
+
+	WdTrigger( llHdl );
+}
+
+/********************************* WdLeaseLeft ******************************/
+/** Get the remaining time of the watchdog lease
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           remaining time [ms], 0 if lapsed or not active
+ */
+static u_int32 WdLeaseLeft( LL_HANDLE *llHdl )
+{
+	int32	left = 0;
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( llHdl->wdLease && llHdl->job[JOB_WDOG].msec && !llHdl->wdLapsed )
+		left = (int32)(llHdl->wdLeaseEnd - OSS_TickGet( llHdl->osHdl ));
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return( left > 0 ? TicksToMsec( llHdl, (u_int32)left ) : 0 );
+}
+
+/********************************* WdCoalMsec *******************************/
+/** Get the current watchdog trigger coalescing interval
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *
+ *  \return           interval [ms], 0 if coalescing is off
+ */
+static u_int32 WdCoalMsec( LL_HANDLE *llHdl )
+{
+	u_int8	tout;
+
+	if( !llHdl->wdCoal || RegRead( llHdl, XC02C_WDOG_TOUT, &tout ) )
+		return( 0 );
+
+	return( (u_int32)tout * 100 / llHdl->wdCoal );
+}
+
+/********************************** WdStatGet *******************************/
+/** Copy the watchdog trigger counters, optionally reset them
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param ws         \IN  flags: XC02_WDOG_STATS_RESET
+ *                    \OUT counters
+ */
+static void WdStatGet( LL_HANDLE *llHdl, XC02_BLK_WDOG_STATS *ws )
+{
+	u_int32	flags = ws->flags;
+
+	ws->minMsec = WdCoalMsec( llHdl );
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	ws->issued		= llHdl->wdIssued;
+	ws->coalesced	= llHdl->wdCoalesced;
+	ws->failed		= llHdl->wdFailed;
+	if( flags & XC02_WDOG_STATS_RESET )
+		llHdl->wdIssued = llHdl->wdCoalesced = llHdl->wdFailed = 0;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_2((DBH, " - XC02_BLK_WDOG_STATS_GET: issued=%d coalesced=%d\n",
+			  ws->issued, ws->coalesced));
+}
+
+/********************************* WdCliFind ********************************/
+/** Find the slot of a watchdog client id
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param id         \IN  client id
+ *
+ *  \return           slot or -1 if not found
+ */
+static int32 WdCliFind( LL_HANDLE *llHdl, u_int32 id )
+{
+	int32	slot;
+
+	for( slot=0; slot<WD_CLI_NUM; slot++ )
+		if( llHdl->wdCli[slot].id && (llHdl->wdCli[slot].id == id) )
+			return( slot );
+
+	return( -1 );
+}
+
+/******************************** WdCliRegister *****************************/
+/** Register a watchdog client
+ *
+ *  The client's deadline starts running immediately.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param reg        \IN  client settings
+ *  \param size       \IN  size of settings
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 WdCliRegister(
+	LL_HANDLE				*llHdl,
+	XC02_BLK_WDOG_CLIENT	*reg,
+	int32					size )
+{
+	WD_CLI	*cli;
+	int32	slot;
+
+	/* check buf size */
+	if( size < (int32)sizeof(XC02_BLK_WDOG_CLIENT) )
+		return(ERR_LL_USERBUF);
+
+	DBGWRT_2((DBH, " - XC02_BLK_WDOG_REGISTER: id=0x%x deadline=%dms\n",
+			  reg->id, reg->deadline));
+
+	if( (reg->id == 0) || (reg->id == XC02_WDOG_ID_LEASE) ||
+		(reg->deadline < WD_LEASE_MIN) )
+		return(ERR_LL_ILL_PARAM);
+
+	/* id already used ? */
+	if( WdCliFind( llHdl, reg->id ) >= 0 ){
+		DBGWRT_ERR((DBH, " *** WdCliRegister: id 0x%x already used\n",
+					reg->id));
+		return(ERR_LL_ILL_ID);
+	}
+
+	/* find free slot */
+	for( slot=0; slot<WD_CLI_NUM; slot++ )
+		if( llHdl->wdCli[slot].id == 0 )
+			break;
+
+	if( slot == WD_CLI_NUM ){
+		DBGWRT_ERR((DBH, " *** WdCliRegister: no free client slot\n"));
+		return(ERR_LL_DEV_BUSY);
+	}
+
+	cli = &llHdl->wdCli[slot];
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	OSS_MemCopy( llHdl->osHdl, WD_NAME_LEN, reg->name, cli->name );
+	cli->name[WD_NAME_LEN-1] = '\0';
+	cli->deadline	= reg->deadline;
+	cli->end		= OSS_TickGet( llHdl->osHdl ) +
+		MsecToTicks( llHdl, reg->deadline );
+	cli->id			= reg->id;
+	llHdl->wdCliNum++;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return( WdLeaseUpdate( llHdl ) );
+}
+
+/******************************* WdCliUnregister ****************************/
+/** Remove a watchdog client
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param id         \IN  client id
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 WdCliUnregister( LL_HANDLE *llHdl, u_int32 id )
+{
+	int32	slot;
+
+	DBGWRT_2((DBH, " - XC02_WDOG_UNREGISTER: id=0x%x\n", id));
+
+	if( (slot = WdCliFind( llHdl, id )) < 0 )
+		return(ERR_LL_ILL_ID);
+
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	llHdl->wdCli[slot].id = 0;
+	llHdl->wdCliNum--;
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return( WdLeaseUpdate( llHdl ) );
+}
+
+/********************************* WdCliCheckin *****************************/
+/** Renew the deadline of a watchdog client
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param id         \IN  client id
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 WdCliCheckin( LL_HANDLE *llHdl, u_int32 id )
+{
+	WD_CLI	*cli;
+	int32	slot, error = ERR_SUCCESS;
+
+	if( (slot = WdCliFind( llHdl, id )) < 0 )
+		return(ERR_LL_ILL_ID);
+
+	cli = &llHdl->wdCli[slot];
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	if( llHdl->wdLapsed )
+		error = ERR_LL_DEV_NOTRDY;
+	else
+		cli->end = OSS_TickGet( llHdl->osHdl ) +
+			MsecToTicks( llHdl, cli->deadline );
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	return( error );
+}
+
+/******************************** WdStarvedGet ******************************/
+/** Get the client that starved the watchdog
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param st         \OUT starved client, id 0: none
+ */
+static void WdStarvedGet( LL_HANDLE *llHdl, XC02_BLK_WDOG_STARVED *st )
+{
+	OSS_SpinLockAcquire( llHdl->osHdl, llHdl->smpLock );
+	st->id			= llHdl->wdLapsed ? llHdl->wdStarved.id : 0;
+	st->deadline	= llHdl->wdStarved.deadline;
+	st->tick		= llHdl->wdStarved.end;
+	OSS_MemCopy( llHdl->osHdl, WD_NAME_LEN, llHdl->wdStarved.name,
+				 st->name );
+	OSS_SpinLockRelease( llHdl->osHdl, llHdl->smpLock );
+
+	DBGWRT_2((DBH, " - XC02_BLK_WDOG_STARVED_GET: id=0x%x\n", st->id));
+}
+
+/******************************* BurstMaskInit ******************************/
+/** Mark the registers which may be read by a burst
+ *
+ *  Only registers readable by a register descriptor qualify. Undefined
+ *  and write only command registers are excluded, as is XC02C_TIMESTAMP
+ *  whose read steps through the EEPROM timestamp string.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ */
+static void BurstMaskInit( LL_HANDLE *llHdl )
+{
+	const REG_DESC	*d;
+	u_int32			i;
+
+	OSS_MemFill( llHdl->osHdl, sizeof(llHdl->burstOk),
+				 (char*)llHdl->burstOk, 0x00 );
+
+	for( i=0; i<REG_DESC_NUM; i++ ){
+		d = &G_RegDesc[i];
+		if( !(d->acc & ACC_R) || (d->cmd == XC02C_TIMESTAMP) ||
+			(d->cmd >= SHADOW_SIZE) )
+			continue;
+		llHdl->burstOk[d->cmd] = 1;
+		if( (d->conv == CONV_WORD) && (d->cmd+1 < SHADOW_SIZE) )
+			llHdl->burstOk[d->cmd+1] = 1;
+	}
+}
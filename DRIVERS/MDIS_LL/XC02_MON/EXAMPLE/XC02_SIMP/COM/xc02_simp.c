@@ -78,8 +78,10 @@ static void PrintError(char *info)
 int main(int argc, char *argv[])
 {
 	MDIS_PATH path; /* value, arg_bright, */
-	int32 i;
+	int32 i, state;
 	char  *device;
+	M_SG_BLOCK    blk;
+	XC02_BLK_FADE fade;
 
 	if (argc < 2 ) {
 		printf("Syntax: xc02_simp <device> \n");
@@ -113,12 +115,25 @@ int main(int argc, char *argv[])
 	}
 
 	/*
-	 * 2. run a brightness ramp from dark (0xc8) to bright (0x0)
+	 * 2. run a brightness ramp from dark (0xc8) to bright (0x0) in 4s,
+	 *    the driver steps the brightness itself
 	 */
-	for (i = 200; i > 0 ; i-=5 ) {
- 		CHK((M_setstat( path, XC02_BRIGHTNESS, i)),	"setstat XC02_BRIGHTNESS");
+ 	CHK((M_setstat( path, XC02_BRIGHTNESS, 200)), "setstat XC02_BRIGHTNESS");
+
+	blk.size	 = sizeof(fade);
+	blk.data	 = (void*)&fade;
+	fade.screen	 = 0;
+	fade.target	 = 0;
+	fade.msec	 = 4000;
+	fade.curve	 = XC02_FADE_LINEAR;
+	CHK((M_setstat( path, XC02_BLK_FADE_SET, (INT32_OR_64)&blk)),
+		"setstat XC02_BLK_FADE_SET");
+
+	do {
 		UOS_Delay( 100 );
-	}
+		CHK((M_getstat( path, XC02_FADE_STATE, &state)),
+			"getstat XC02_FADE_STATE");
+	} while( state );
 
 
 	/*--------------------+
@@ -62,6 +62,7 @@ static void __MAPILIB SigHandler(u_int32 sigCode);
 #define IO_MAX_NBR  8
 
 #define TEMP_INF    99999   /* if no temperature was passed */
+#define SNAP_ERR    "<read error>"	/* snapshot field not valid */
 
 /* more compact error handling */
 #define CHK(expression,errst)       \
@@ -119,102 +120,107 @@ static void usage(void)
 static int showInfo(void)
 {
 
-    int32   val, chan;
+    int32   val;
 	float mul=0.0;
+	M_SG_BLOCK        blk;
+	XC02_BLK_CONFIG   cfg;
+	XC02_BLK_SNAPSHOT snap;
+
+	/* complete configuration and telemetry with two calls */
+	blk.size = sizeof(cfg);
+	blk.data = (void*)&cfg;
+	CHK((M_getstat(G_Path, XC02_BLK_CONFIG_GET, (int32*)&blk)),
+		" XC02_BLK_CONFIG_GET");
+
+	blk.size = sizeof(snap);
+	blk.data = (void*)&snap;
+	CHK((M_getstat(G_Path, XC02_BLK_SNAPSHOT_GET, (int32*)&blk)),
+		" XC02_BLK_SNAPSHOT_GET");
 
 	printf("current settings:\n");
 
-	CHK((M_getstat(G_Path, XC02_WOT, &val))," XC02_WOT" );
-	printf("- wake on time                : %dmin\n", val);
+	printf("- wake on time                : %dmin\n", cfg.wot);
 
 	CHK((M_getstat(G_Path, XC02_WDOG_ERR, &val))," XC02_WDOG_ERR" );
 	printf("- missing wdog triggers       : %d\n", val);
 
-	CHK((M_getstat(G_Path, XC02_DOWN_DELAY, &val))," XC02_DOWN_DELAY");
 	printf("- shutdown delay              : %d min\n",
-		   XC02C_DOWN_DELAY_MIN( val ));
+		   XC02C_DOWN_DELAY_MIN( cfg.downDelay ));
 
-	CHK((M_getstat(G_Path, XC02_OFF_DELAY, &val))," XC02_OFF_DELAY");
 	printf("- off delay                   : %dmin\n",
-		   XC02C_OFF_DELAY_MIN( val ));
+		   XC02C_OFF_DELAY_MIN( cfg.offDelay ));
 
-	CHK((M_getstat(G_Path, XC02_DOWN_EVT, &val))," XC02_DOWN_EVT");
-	printf("- shutdown event flag         : %d\n", val);
+	/* fields which could not be read have their valid flag cleared */
+	if( snap.valid & XC02_SNAP_STATUS )
+		printf("- shutdown event flag         : %d\n",
+			   snap.status & (XC02C_STATUS_DOWN_EVT|XC02C_STATUS_PROTECT));
+	else
+		printf("- shutdown event flag         : %s\n", SNAP_ERR);
 
-	CHK( (M_getstat(G_Path, XC02_IN, &val)), " XC02_IN");
-	printf("- binary inputs               : 0x%x\n", val );
+	if( snap.valid & XC02_SNAP_IN )
+		printf("- binary inputs               : 0x%x\n", snap.in );
+	else
+		printf("- binary inputs               : %s\n", SNAP_ERR);
 
-	CHK( (M_getstat(G_Path, XC02_VOLTAGE, &val))," XC02_VOLTAGE");
-	printf("- Voltage                     : %d mV (raw 0x%x)\n",
-		   XC02_ADC2VOLT(val), val);
+	if( snap.valid & XC02_SNAP_VOLT )
+		printf("- Voltage                     : %d mV (raw 0x%x)\n",
+			   XC02_ADC2VOLT(snap.volt), snap.volt);
+	else
+		printf("- Voltage                     : %s\n", SNAP_ERR);
 
-	CHK( (M_getstat(G_Path, XC02_BRIGHTNESS, &val))," XC02_BRIGHTNESS");
-	printf("- Brightness                  : %d% (raw 0x%x)\n",
-		   100 - (val >> 1), val);
+	if( snap.valid & XC02_SNAP_BRIGHT )
+		printf("- Brightness                  : %d% (raw 0x%x)\n",
+			   100 - (snap.bright >> 1), snap.bright);
+	else
+		printf("- Brightness                  : %s\n", SNAP_ERR);
 
-	CHK((M_getstat(G_Path, XC02_RAW_BRIGHTNESS, &val))," XC02_RAW_BRIGHTNESS");
-	printf("- Brightness Raw ADC          : %d \n", val);
+	if( snap.valid & XC02_SNAP_BR_RAW )
+		printf("- Brightness Raw ADC          : %d \n", snap.brRaw);
+	else
+		printf("- Brightness Raw ADC          : %s\n", SNAP_ERR);
 
-	CHK((M_getstat(G_Path, XC02_BR_SRC, &val )), " XC02_BR_SRC");
-	printf("- brightness source           : %s\n", val ? "auto" : "manual");
+	printf("- brightness source           : %s\n", cfg.brSrc ? "auto" : "manual");
 
-	CHK( (M_getstat(G_Path, XC02_BR_OFFS, &val))," XC02_BR_OFFS");
-	printf("- Brightness offset           : 0x%02x\n", val);
+	printf("- Brightness offset           : 0x%02x\n", cfg.brOffs);
 
-	CHK( (M_getstat(G_Path, XC02_BR_MULT, &val))," XC02_BR_MULT");
-	mul=(float)((float)val/10.0);
-	printf("- Brightness multiplier       : %1.1f\n", mul/*(float)(val/10)*/);
+	mul=(float)((float)cfg.brMult/10.0);
+	printf("- Brightness multiplier       : %1.1f\n", mul);
 
-	CHK((M_getstat(G_Path, XC02_DISP_INITSTAT, &val )), "XC02_DISP_INITSTAT");
-	printf("- initial displaystatus       : pri: %s sec: %s\n", (val&0x1) ? "ON" : "OFF",  (val&0x2) ? "ON" : "OFF" );
+	printf("- initial displaystatus       : pri: %s sec: %s\n", (cfg.initDispStat&0x1) ? "ON" : "OFF",  (cfg.initDispStat&0x2) ? "ON" : "OFF" );
 
-	chan = 0;
-	CHK((M_setstat(G_Path, M_MK_CH_CURRENT, chan)), "M_MK_CH_CURRENT");
-
-	CHK((M_getstat(G_Path, XC02_INIT_BRIGHT, &val )), "XC02_INIT_BRIGHT");
 	printf("- initial brightness 1        : %d % (raw 0x%x)\n",
-		   100 - (val >> 1), val);
-	chan = 1;
-	CHK((M_setstat(G_Path, M_MK_CH_CURRENT, chan)), "M_MK_CH_CURRENT");
-	CHK((M_getstat(G_Path, XC02_INIT_BRIGHT, &val )), "XC02_INIT_BRIGHT");
+		   100 - (cfg.initBright[0] >> 1), cfg.initBright[0]);
 	printf("- initial brightness 2(option): %d % (raw 0x%x)\n",
-		   100 - (val >> 1), val);
+		   100 - (cfg.initBright[1] >> 1), cfg.initBright[1]);
 
 	/* Temp & limits */
-	CHK( (M_getstat(G_Path, XC02_TEMP, &val)),   " XC02_TEMP");
-	printf("- temperature          	      : %d degree Celsius(raw 0x%x)\n",
-		   XC02_ADC2TEMP(val), val);
-
-	CHK((M_getstat(G_Path, XC02_TEMP_HIGH, &val))," TEMP_HIGH");
-	printf("- Temp high limit             : %d degree Celsius\n", val);
+	if( snap.valid & XC02_SNAP_TEMP )
+		printf("- temperature          	      : %d degree Celsius(raw 0x%x)\n",
+			   XC02_ADC2TEMP(snap.temp), snap.temp);
+	else
+		printf("- temperature                 : %s\n", SNAP_ERR);
 
-	CHK((M_getstat(G_Path, XC02_TEMP_LOW, &val))," TEMP_LOW");
-	printf("- Temp low limit              : %d degree Celsius\n", val);
+	printf("- Temp high limit             : %d degree Celsius\n", cfg.tempHigh);
 
-	CHK( (M_getstat(G_Path, XC02_VOLTAGE, &val))," XC02_VOLTAGE");
-	printf("- Voltage                     : %d mV (raw 0x%x)\n",
-		   XC02_ADC2VOLT(val), val);
+	printf("- Temp low limit              : %d degree Celsius\n", cfg.tempLow);
 
-	CHK((M_getstat(G_Path, XC02_VOLT_HIGH, &val))," VOLT_HIGH");
 	printf("- Volt high limit             : %d mV\n",
-		   XC02_ADC2VOLT(val));
+		   XC02_ADC2VOLT(cfg.voltHigh));
 
-	CHK((M_getstat(G_Path, XC02_VOLT_LOW, &val))," VOLT_LOW");
 	printf("- Volt low limit              : %d mV\n",
-		   XC02_ADC2VOLT(val));
+		   XC02_ADC2VOLT(cfg.voltLow));
 
-    CHK((M_getstat(G_Path, XC02_KEY_IN_CTRL, &val))," XC02_KEY_IN_CTRL");
-    printf("- KEY_IN control:             : %d (%s)\n", val, val ? "always on" : "KEY_IN");
+    printf("- KEY_IN control:             : %d (%s)\n", cfg.keyInCtrl, cfg.keyInCtrl ? "always on" : "KEY_IN");
 
-	CHK((M_getstat(G_Path, SC21_BL_CURRENT, &val )), " SC21_BL_CURRENT");
-	if (val == 0xff) {
-		printf("- drawn power (12V rail)      : <unknown>\n", SC21_ADC2POWER(val));
+	if (!(snap.valid & XC02_SNAP_BL_CURR)) {
+		printf("- drawn power (12V rail)      : %s\n", SNAP_ERR);
+	} else if (snap.blCurr == 0xff) {
+		printf("- drawn power (12V rail)      : <unknown>\n");
 	} else {
-		printf("- drawn power (12V rail)      : %d W\n", SC21_ADC2POWER(val));
+		printf("- drawn power (12V rail)      : %d W\n", SC21_ADC2POWER(snap.blCurr));
 	}
 
-    CHK((M_getstat(G_Path, XC02_AUTO_BRIGHT_CTRL, &val))," XC02_AUTO_BRIGHT_CTRL");
-    printf("- auto brightness direction   : %d (%s)\n", val, val ? "DC2/6" : "default");
+    printf("- auto brightness direction   : %d (%s)\n", cfg.autoBrightDir, cfg.autoBrightDir ? "DC2/6" : "default");
 
 	/* PIC firmware built string */
 	printf("firmware build string:\n");
@@ -482,6 +488,10 @@ int main( int argc, char *argv[])
 
         downSig.msec    = sdEvtPollTime;
         downSig.signal  = UOS_SIG_USR1;
+        downSig.mode    = XC02_DOWN_SIG_LEVEL;
+        downSig.rearm   = 0;
+        downSig.minMsec = 0;
+        downSig.maxMsec = 0;
 
         /* install signal handler */
         if( UOS_SigInit(SigHandler) ){
@@ -575,49 +585,77 @@ static void PrintUosError(char *info)
 static int ShowIo( void )
 {
     int32 val;
+    M_SG_BLOCK        blk;
+    XC02_BLK_SNAPSHOT snap;
 
     printf(" -------- binary i/o, temp and volt states: -------\n");
 
-    /* binary inputs state , val contains raw value */
-    CHK( (M_getstat(G_Path, XC02_IN, &val))," XC02_IN");
-    printf("- binary inputs: KEY_IN = %d  GA[3:0] = 0x%x\n",
-           val & 0x1, (val>>1) & 0xf);
+    /* all volatile values with one call */
+    blk.size = sizeof(snap);
+    blk.data = (void*)&snap;
+    CHK( (M_getstat(G_Path, XC02_BLK_SNAPSHOT_GET, (int32*)&blk)),
+         " XC02_BLK_SNAPSHOT_GET");
+
+    /* binary inputs state , raw value */
+    if( snap.valid & XC02_SNAP_IN )
+        printf("- binary inputs: KEY_IN = %d  GA[3:0] = 0x%x\n",
+               snap.in & 0x1, (snap.in>>1) & 0xf);
+    else
+        printf("- binary inputs:                       %s\n", SNAP_ERR);
     /* temp */
-    CHK( (M_getstat(G_Path, XC02_TEMP, &val)),   " XC02_TEMP");
-    printf("- temperature :                        %d degree celsius (raw 0x%x)\n",
-           XC02_ADC2TEMP(val), val);
+    if( snap.valid & XC02_SNAP_TEMP )
+        printf("- temperature :                        %d degree celsius (raw 0x%x)\n",
+               XC02_ADC2TEMP(snap.temp), snap.temp);
+    else
+        printf("- temperature :                        %s\n", SNAP_ERR);
 
     /* voltage */
-    CHK( (M_getstat(G_Path, XC02_VOLTAGE, &val))," XC02_VOLTAGE");
-    printf("- Voltage:                             %d mV  (raw 0x%x)\n",
-           XC02_ADC2VOLT(val), val);
+    if( snap.valid & XC02_SNAP_VOLT )
+        printf("- Voltage:                             %d mV  (raw 0x%x)\n",
+               XC02_ADC2VOLT(snap.volt), snap.volt);
+    else
+        printf("- Voltage:                             %s\n", SNAP_ERR);
 
-    CHK((M_getstat(G_Path, XC02_DOWN_EVT, &val)), "XC02_DOWN_EVT");
-    printf("- shutdown event flag:                 %d\n", val);
+    if( snap.valid & XC02_SNAP_STATUS )
+        printf("- shutdown event flag:                 %d\n",
+               snap.status & (XC02C_STATUS_DOWN_EVT|XC02C_STATUS_PROTECT));
+    else
+        printf("- shutdown event flag:                 %s\n", SNAP_ERR);
 
-    CHK((M_getstat(G_Path, XC02_SW_DISP,  &val )), "XC02_SW_DISP");
-    printf("- display switch status:               %d\n", val);
+    if( snap.valid & XC02_SNAP_SW_DISP )
+        printf("- display switch status:               %d\n", snap.swDisp);
+    else
+        printf("- display switch status:               %s\n", SNAP_ERR);
 
     /* brightness */
-    CHK( (M_getstat(G_Path, XC02_BRIGHTNESS, &val))," XC02_BRIGHTNESS");
-    printf("- Brightness screen1: %d % (raw 0x%02x) ", 100-(val>>1), val);
+    if( snap.valid & XC02_SNAP_BRIGHT )
+        printf("- Brightness screen1: %d % (raw 0x%02x) ",
+               100-(snap.bright>>1), snap.bright);
+    else
+        printf("- Brightness screen1: %s ", SNAP_ERR);
     /* brightness2 */
-    CHK( (M_getstat(G_Path, XC02_BRIGHTNESS2, &val)), " XC02_BRIGHTNESS2");
-    printf(                                      "screen2: %d % (raw 0x%x)\n", 100-(val>>1), val);
+    if( snap.valid & XC02_SNAP_BRIGHT2 )
+        printf(                                  "screen2: %d % (raw 0x%x)\n",
+               100-(snap.bright2>>1), snap.bright2);
+    else
+        printf(                                  "screen2: %s\n", SNAP_ERR);
 
-    CHK((M_getstat(G_Path, XC02_RAW_BRIGHTNESS, &val))," XC02_RAW_BRIGHTNESS");
-    printf("- Brightness Raw ADC value:            0x%02x \n", val);
+    if( snap.valid & XC02_SNAP_BR_RAW )
+        printf("- Brightness Raw ADC value:            0x%02x \n", snap.brRaw);
+    else
+        printf("- Brightness Raw ADC value:            %s\n", SNAP_ERR);
 
     CHK((M_getstat(G_Path, XC02_KEY_IN_CTRL, &val))," XC02_KEY_IN_CTRL");
     printf("- KEY_IN control:                      0x%02x (%s)\n", val, val ? "always on" : "KEY_IN");
 
 
-	CHK((M_getstat(G_Path, SC21_BL_CURRENT, &val )), " SC21_BL_CURRENT");
-	if (val == 0xff) {
+	if (!(snap.valid & XC02_SNAP_BL_CURR)) {
+		printf("- drawn power (12V rail):              %s\n", SNAP_ERR);
+	} else if (snap.blCurr == 0xff) {
 		/* 0xff returned, no register implemented (XC02) */
 		printf("- drawn power (12V rail):              <unknown>\n"); 
 	} else {
-		printf("- drawn power (12V rail):              %d W\n", SC21_ADC2POWER(val));
+		printf("- drawn power (12V rail):              %d W\n", SC21_ADC2POWER(snap.blCurr));
 	}
 
     /* Temp Limits */
@@ -40,12 +40,328 @@
 /*-----------------------------------------+
 |  TYPEDEFS                                |
 +-----------------------------------------*/
-/** structure for #XC02_BLK_DOWN_SIG_SET setstat */
+#define XC02_BATCH_MAX	32	/**< max. entries of #XC02_BLK_BATCH */
+#define XC02_IN_EVT_MAX	16	/**< max. entries of #XC02_BLK_IN_EVT */
+#define XC02_SUBSCR_MAX	8	/**< max. subscribers of #XC02_BLK_SUBSCRIBE */
+#define XC02_LOG_MAX	32	/**< max. entries of #XC02_BLK_LOG */
+#define XC02_BR_LUT_SIZE 256 /**< entries of #XC02_BLK_BR_LUT */
+#define XC02_ABR_PTS_MAX 8	/**< max. points of #XC02_BLK_ABR */
+#define XC02_DERATE_PTS_MAX 4 /**< max. points of #XC02_BLK_DERATE */
+#define XC02_TRACE_MAX	32	/**< max. entries of #XC02_BLK_TRACE */
+#define XC02_TRACE_STATES 8	/**< firmware states of #XC02_BLK_TRACE_STATS */
+#define XC02_WDOG_CLIENT_MAX 8	/**< max. clients of #XC02_BLK_WDOG_REGISTER */
+#define XC02_WDOG_NAME_LEN 16	/**< name length of #XC02_BLK_WDOG_CLIENT */
+
+/** \name Channels of #XC02_BLK_STATS
+ *  \anchor XC02_STAT_xxx
+ */
+/**@{*/
+#define XC02_STAT_TEMP		0	/**< temperature */
+#define XC02_STAT_VOLT		1	/**< display supply voltage */
+#define XC02_STAT_BL_CURR	2	/**< SC21 only: backlight current */
+#define XC02_STAT_BR_RAW	3	/**< photo sensor raw value */
+#define XC02_STAT_CH_NUM	4	/**< number of statistics channels */
+#define XC02_STAT_RESET		0x01 /**< flag: reset statistics after read */
+/**@}*/
+
+/** structure for #XC02_BLK_DOWN_SIG_SET setstat
+ *  (may be passed without the optional fields: without \a mode and
+ *   \a rearm level mode is used, without \a minMsec and \a maxMsec the
+ *   fixed period \a msec) */
 typedef struct {
 	u_int32 msec;			/* poll period [msec] */
-	u_int32 signal;			/* signal to send */
+	u_int32 signal;			/* signal to send, 0: none (poll for\n
+							   #XC02_BLK_SUBSCRIBE subscribers only) */
+	u_int32 mode;			/* #XC02_DOWN_SIG_LEVEL or #XC02_DOWN_SIG_EDGE */
+	u_int32 rearm;			/* edge mode: resend interval while the event\n
+							   is pending [msec], 0: never */
+	u_int32 minMsec;		/* adaptive poll: period on activity [msec] */
+	u_int32 maxMsec;		/* adaptive poll: period when idle [msec]\n
+							   (0/0: fixed period \a msec) */
 } XC02_BLK_DOWN_SIG;
 
+#define XC02_DOWN_SIG_LEVEL	0	/**< signal on every poll while event is set */
+#define XC02_DOWN_SIG_EDGE	1	/**< signal once per rising edge of event */
+
+/** structure for #XC02_BLK_THRESH_SET setstat */
+typedef struct {
+	u_int32 msec;			/* poll period [msec] */
+	u_int32 signal;			/* signal to send on state change, 0: none */
+	u_int32 mask;			/* checked channels: #XC02_THR_TEMP, #XC02_THR_VOLT */
+	int32	tempHigh;		/* temp warning high limit [C] */
+	int32	tempLow;		/* temp warning low limit [C] */
+	int32	tempHyst;		/* temp hysteresis [C] */
+	int32	voltHigh;		/* volt warning high limit [mV at ADC] */
+	int32	voltLow;		/* volt warning low limit [mV at ADC] */
+	int32	voltHyst;		/* volt hysteresis [mV] */
+} XC02_BLK_THRESH;
+
+/** structure for #XC02_BLK_IN_SIG_SET setstat */
+typedef struct {
+	u_int32 msec;			/* poll period [msec] */
+	u_int32 signal;			/* signal to send on input change, 0: none */
+	u_int32 mask;			/* watched #XC02_IN bits, 0: all */
+} XC02_BLK_IN_SIG;
+
+/** one input transition of #XC02_BLK_IN_EVT */
+typedef struct {
+	u_int32	tick;			/* time of detection [OSS ticks] */
+	u_int8	oldVal;			/* previous #XC02_IN value */
+	u_int8	newVal;			/* new #XC02_IN value */
+	u_int8	_rsvd[2];		/* reserved */
+} XC02_IN_EVT;
+
+/** structure for #XC02_BLK_IN_EVT_GET getstat */
+typedef struct {
+	u_int32		num;		/* number of valid entries */
+	u_int32		lost;		/* transitions lost since last read */
+	XC02_IN_EVT	evt[XC02_IN_EVT_MAX];	/* transitions, oldest first */
+} XC02_BLK_IN_EVT;
+
+/** structure for #XC02_BLK_SUBSCRIBE setstat */
+typedef struct {
+	u_int32 id;				/* subscriber id, chosen by caller (!=0) */
+	u_int32 signal;			/* signal to send */
+	u_int32 evtMask;		/* events of interest, \ref XC02_EVT_xxx */
+} XC02_BLK_SUBSCR;
+
+/** one event of #XC02_BLK_LOG */
+typedef struct {
+	u_int32	seq;			/* sequence number */
+	u_int32	tick;			/* time of event [OSS ticks] */
+	u_int8	type;			/* event type, \ref XC02_LOG_xxx */
+	u_int8	_rsvd[3];		/* reserved */
+	u_int32	data;			/* event data, see \ref XC02_LOG_xxx */
+} XC02_LOG_ENTRY;
+
+/** structure for #XC02_BLK_LOG_GET getstat */
+typedef struct {
+	u_int32			seq;	/* IN: first wanted sequence number\n
+							   OUT: cursor for the next call */
+	u_int32			num;	/* number of valid entries */
+	u_int32			lost;	/* wanted entries already overwritten */
+	XC02_LOG_ENTRY	ent[XC02_LOG_MAX];	/* entries, oldest first */
+} XC02_BLK_LOG;
+
+/** structure for #XC02_BLK_FADE_SET setstat */
+typedef struct {
+	u_int32	screen;			/* 0: #XC02_BRIGHTNESS, 1: #XC02_BRIGHTNESS2 */
+	u_int32	target;			/* target brightness 0..200 or, with\n
+							   #XC02_FADE_LEVEL, logical level 0..255 */
+	u_int32	msec;			/* fade duration [msec], max. 60000 */
+	u_int32	curve;			/* #XC02_FADE_LINEAR, #XC02_FADE_EASE or\n
+							   #XC02_FADE_SQUARE, optionally ORed\n
+							   with #XC02_FADE_LEVEL */
+} XC02_BLK_FADE;
+
+#define XC02_FADE_LINEAR	0	/**< constant rate */
+#define XC02_FADE_EASE		1	/**< slow start and end (smoothstep) */
+#define XC02_FADE_SQUARE	2	/**< slow start, fast end */
+#define XC02_FADE_LEVEL		0x100	/**< flag: fade logical levels, mapped\n
+									 by #XC02_BLK_BR_LUT */
+
+/** structure for #XC02_BLK_BR_LUT_SET setstat */
+typedef struct {
+	u_int8	pwm[XC02_BR_LUT_SIZE];	/* brightness register value 0..200\n
+									   for each logical level 0..255 */
+} XC02_BLK_BR_LUT;
+
+/** one point of the ambient curve of #XC02_BLK_ABR */
+typedef struct {
+	u_int8	raw;			/* filtered #XC02_RAW_BRIGHTNESS value */
+	u_int8	level;			/* logical brightness level 0..255 */
+	u_int8	_rsvd[2];		/* reserved */
+} XC02_ABR_POINT;
+
+/** structure for #XC02_BLK_ABR_SET setstat */
+typedef struct {
+	u_int32	msec;			/* sample period [msec], min. 10 */
+	u_int32	screens;		/* controlled screens, bit0: 0, bit1: 1 */
+	u_int32	deadband;		/* min. level change before writing */
+	u_int32	num;			/* number of valid points 2..8 */
+	XC02_ABR_POINT pt[XC02_ABR_PTS_MAX];	/* ambient curve, raw values\n
+											   strictly ascending */
+} XC02_BLK_ABR;
+
+/** one point of the derating curve of #XC02_BLK_DERATE */
+typedef struct {
+	u_int8	delta;			/* distance to #XC02_TEMP_HIGH [C] */
+	u_int8	level;			/* max. logical brightness level 0..255 */
+	u_int8	_rsvd[2];		/* reserved */
+} XC02_DERATE_POINT;
+
+/** structure for #XC02_BLK_DERATE_SET setstat */
+typedef struct {
+	u_int32	msec;			/* temperature poll period [msec], min. 100 */
+	u_int32	screens;		/* derated screens, bit0: 0, bit1: 1 */
+	u_int32	hyst;			/* hysteresis before the cap is raised [C] */
+	u_int32	num;			/* number of valid points 2..4 */
+	XC02_DERATE_POINT pt[XC02_DERATE_PTS_MAX];	/* derating curve, delta\n
+												   strictly ascending */
+} XC02_BLK_DERATE;
+
+/** structure for #XC02_BLK_SNAPSHOT_GET getstat */
+typedef struct {
+	u_int32 version;		/* structure version (#XC02_SNAPSHOT_VERSION) */
+	u_int32 valid;			/* valid fields, see \ref XC02_SNAP_xxx flags */
+	u_int32 tick;			/* capture time [OSS ticks] */
+	u_int32 tickRate;		/* OSS ticks per second */
+	u_int8	temp;			/* temperature [ADC value] */
+	u_int8	volt;			/* display supply voltage [ADC value] */
+	u_int8	in;				/* binary inputs, see #XC02_IN */
+	u_int8	status;			/* status flags (down event, protect) */
+	u_int8	swDisp;			/* display switch state */
+	u_int8	bright;			/* primary screen brightness */
+	u_int8	bright2;		/* 2nd screen brightness */
+	u_int8	brRaw;			/* photo sensor raw ADC value */
+	u_int8	blCurr;			/* SC21 only: backlight current [ADC value] */
+	u_int8	_rsvd[3];		/* reserved */
+} XC02_BLK_SNAPSHOT;
+
+/** structure for #XC02_BLK_CONFIG_GET getstat */
+typedef struct {
+	u_int32 version;		/* structure version (#XC02_CONFIG_VERSION) */
+	u_int32 wot;			/* wake on time [min] */
+	u_int32 wdogTime;		/* watchdog timeout [ms] */
+	int32	tempHigh;		/* temp high limit [C] */
+	int32	tempLow;		/* temp low limit [C] */
+	u_int8	voltHigh;		/* volt high limit [ADC value] */
+	u_int8	voltLow;		/* volt low limit [ADC value] */
+	u_int8	downDelay;		/* shutdown delay mode */
+	u_int8	offDelay;		/* off delay mode */
+	u_int8	brSrc;			/* brightness control source */
+	u_int8	brMult;			/* auto brightness multiplier (x0.1) */
+	u_int8	brOffs;			/* auto brightness offset */
+	u_int8	initDispStat;	/* initial display state */
+	u_int8	initBright[2];	/* initial brightness display 1/2 */
+	u_int8	keyInCtrl;		/* KEY_IN control behavior */
+	u_int8	autoBrightDir;	/* auto brightness direction */
+	u_int8	minicardPwr;	/* minicard slot power */
+	u_int8	_rsvd[3];		/* reserved */
+} XC02_BLK_CONFIG;
+
+/** one entry of #XC02_BLK_BATCH */
+typedef struct {
+	int32	code;			/* register based setstat code */
+	int32	ch;				/* channel, e.g. display for #XC02_INIT_BRIGHT */
+	int32	value;			/* value to set */
+} XC02_BATCH_ENTRY;
+
+/** structure for #XC02_BLK_BATCH_SET setstat
+ *  (may be passed with only the first \a num entries) */
+typedef struct {
+	u_int32				num;	/* number of entries (max. #XC02_BATCH_MAX) */
+	XC02_BATCH_ENTRY	entry[XC02_BATCH_MAX];	/* setstats to apply */
+} XC02_BLK_BATCH;
+
+/** one record of the telemetry sampler, read with M_getblock() */
+typedef struct XC02_SMP_REC_S {
+	u_int32	tick;			/* sample time [OSS ticks] */
+	u_int16	valid;			/* valid fields, see \ref XC02_SNAP_xxx flags */
+	u_int8	temp;			/* temperature [ADC value] */
+	u_int8	volt;			/* display supply voltage [ADC value] */
+	u_int8	in;				/* binary inputs, see #XC02_IN */
+	u_int8	blCurr;			/* SC21 only: backlight current [ADC value] */
+	u_int8	brRaw;			/* photo sensor raw ADC value */
+	u_int8	_rsvd;			/* reserved */
+} XC02_SMP_REC;
+
+/** statistics of one telemetry channel (values are raw ADC values) */
+typedef struct {
+	u_int32	count;			/* number of samples */
+	u_int32	sum;			/* sum of samples (wraps around) */
+	u_int32	mean;			/* mean value [ADC value * 256] */
+	u_int32	ewma;			/* exponentially weighted average, alpha 1/16\n
+							   [ADC value * 256] */
+	u_int32	lastChange;		/* time of last value change [OSS ticks] */
+	u_int8	min;			/* minimum value */
+	u_int8	max;			/* maximum value */
+	u_int8	last;			/* last value */
+	u_int8	_rsvd;			/* reserved */
+} XC02_STAT_CH;
+
+/** structure for #XC02_BLK_STATS_GET getstat */
+typedef struct {
+	u_int32			flags;		/* IN: #XC02_STAT_RESET flag */
+	u_int32			tick;		/* read time [OSS ticks] */
+	u_int32			tickRate;	/* OSS ticks per second */
+	XC02_STAT_CH	ch[XC02_STAT_CH_NUM];	/* see \ref XC02_STAT_xxx */
+} XC02_BLK_STATS;
+
+/** structure for #XC02_BLK_ENERGY_GET getstat */
+typedef struct {
+	u_int32	flags;			/* IN: #XC02_ENERGY_RESET */
+	u_int32	mwsLo;			/* backlight energy [mWs], low 32 bit */
+	u_int32	mwsHi;			/* backlight energy [mWs], high 32 bit */
+	u_int32	peakMw;			/* peak backlight power [mW] */
+	u_int32	lastMw;			/* last backlight power [mW] */
+	u_int32	since;			/* time of last reset [OSS ticks] */
+} XC02_BLK_ENERGY;
+
+#define XC02_ENERGY_RESET	0x01	/**< flag: reset counter after read */
+
+/** one firmware state transition of #XC02_BLK_TRACE */
+typedef struct {
+	u_int32	tick;			/* time of detection [OSS ticks] */
+	u_int8	from;			/* previous state (XC02C_SM_STATES) */
+	u_int8	to;				/* new state (XC02C_SM_STATES) */
+	u_int8	_rsvd[2];		/* reserved */
+} XC02_TRACE_EVT;
+
+/** structure for #XC02_BLK_TRACE_GET getstat */
+typedef struct {
+	u_int32			num;	/* number of valid entries */
+	u_int32			lost;	/* transitions lost since last read */
+	XC02_TRACE_EVT	evt[XC02_TRACE_MAX];	/* transitions, oldest first */
+} XC02_BLK_TRACE;
+
+/** dwell time statistics of one firmware state */
+typedef struct {
+	u_int32	count;			/* number of completed stays */
+	u_int32	minMsec;		/* shortest stay [msec] */
+	u_int32	maxMsec;		/* longest stay [msec] */
+	u_int32	sumMsec;		/* sum of all stays [msec] */
+} XC02_TRACE_DWELL;
+
+/** structure for #XC02_BLK_TRACE_STATS_GET getstat */
+typedef struct {
+	u_int32	flags;			/* IN: #XC02_TRACE_RESET */
+	u_int32	state;			/* current state, 0xffffffff: unknown */
+	u_int32	curMsec;		/* time in current state [msec] */
+	XC02_TRACE_DWELL st[XC02_TRACE_STATES];	/* indexed by XC02C_SM_STATES */
+} XC02_BLK_TRACE_STATS;
+
+#define XC02_TRACE_RESET	0x01	/**< flag: reset statistics after read */
+
+/** structure for #XC02_BLK_WDOG_STATS_GET getstat */
+typedef struct {
+	u_int32	flags;			/* IN: #XC02_WDOG_STATS_RESET */
+	u_int32	issued;			/* triggers written to the controller */
+	u_int32	coalesced;		/* triggers suppressed by coalescing */
+	u_int32	failed;			/* trigger writes failed */
+	u_int32	minMsec;		/* current coalescing interval [msec] */
+} XC02_BLK_WDOG_STATS;
+
+#define XC02_WDOG_STATS_RESET	0x01	/**< flag: reset counters after read */
+
+/** structure for #XC02_BLK_WDOG_REGISTER setstat */
+typedef struct {
+	u_int32	id;				/* client id, chosen by caller (!=0) */
+	u_int32	deadline;		/* max. time between check-ins [msec] */
+	char	name[XC02_WDOG_NAME_LEN];	/* client name, for diagnosis */
+} XC02_BLK_WDOG_CLIENT;
+
+/** structure for #XC02_BLK_WDOG_STARVED_GET getstat */
+typedef struct {
+	u_int32	id;				/* starving client, 0: none,\n
+							   #XC02_WDOG_ID_LEASE: #XC02_WDOG_LEASE */
+	u_int32	deadline;		/* its deadline [msec] */
+	u_int32	tick;			/* time of detection [OSS ticks] */
+	char	name[XC02_WDOG_NAME_LEN];	/* its name */
+} XC02_BLK_WDOG_STARVED;
+
+#define XC02_WDOG_ID_LEASE	0xffffffff	/**< id of #XC02_WDOG_LEASE */
+
 /*-----------------------------------------+
 |  DEFINES                                 |
 +-----------------------------------------*/
@@ -111,6 +427,80 @@ typedef struct {
 #define XC02_RAW_BRIGHTNESS      M_DEV_OF+0x20   /**<G  : photo sensor raw ADC value */
 #define XC02_KEY_IN_CTRL  		 M_DEV_OF+0x21   /**<G,S: set KEY_IN control behavior\n*/
 #define XC02_AUTO_BRIGHT_CTRL 	 M_DEV_OF+0x22   /**<G,S: set auto brightness behavior\n*/
+#define XC02_BATCH_APPLIED		 M_DEV_OF+0x23   /**<G  : entries applied by last\n
+													 #XC02_BLK_BATCH_SET\n*/
+#define XC02_BATCH_FAILIDX		 M_DEV_OF+0x24   /**<G  : index of first failing entry\n
+													 of last #XC02_BLK_BATCH_SET\n
+													 (-1: none)\n*/
+#define XC02_SMP_PERIOD			 M_DEV_OF+0x25   /**<G,S: telemetry sampler period\n
+													 [ms], 0: sampler off\n
+													 Default: 0\n*/
+#define XC02_SMP_MASK			 M_DEV_OF+0x26   /**<G,S: sampled channels, \ref
+													 XC02_SNAP_xxx flags of\n
+													 #XC02_SMP_MASK_ALL\n
+													 Default: #XC02_SMP_MASK_ALL\n*/
+#define XC02_SMP_COUNT			 M_DEV_OF+0x27   /**<G,S: G: records in sampler\n
+													 buffer, S: clear buffer\n*/
+#define XC02_SMP_LOST			 M_DEV_OF+0x28   /**<G  : records overwritten\n
+													 since last clear\n*/
+#define XC02_THRESH_CLR			 M_DEV_OF+0x29   /**<  S: Clear threshold\n
+													 signal and monitoring\n*/
+#define XC02_THRESH_STATE		 M_DEV_OF+0x2a   /**<G  : current threshold\n
+													 state, \ref XC02_THR_xxx\n
+													 flags\n*/
+#define XC02_IN_SIG_CLR			 M_DEV_OF+0x2b   /**<  S: Clear signal for\n
+													 input changes\n*/
+#define XC02_DOWN_SIG_SUPPR		 M_DEV_OF+0x2c   /**<G  : shutdown event polls\n
+													 without signal in edge mode\n
+													 (suppressed duplicates)\n*/
+#define XC02_DOWN_SIG_PERIOD	 M_DEV_OF+0x2d   /**<G  : current shutdown event\n
+													 poll period [msec]\n*/
+#define XC02_UNSUBSCRIBE		 M_DEV_OF+0x2e   /**<  S: Remove subscriber with\n
+													 the given id\n*/
+#define XC02_LOG_PERIOD			 M_DEV_OF+0x2f   /**<G,S: poll period of firmware\n
+													 state and watchdog errors\n
+													 for the event log [msec],\n
+													 0: off\n*/
+#define XC02_FADE_STOP			 M_DEV_OF+0x30   /**<  S: Cancel brightness fade\n
+													 of screen 0/1, the current\n
+													 brightness is kept\n*/
+#define XC02_FADE_STATE			 M_DEV_OF+0x31   /**<G  : running brightness\n
+													 fades, bit0: screen 0,\n
+													 bit1: screen 1\n*/
+#define XC02_BR_LEVEL			 M_DEV_OF+0x32   /**<G,S: logical brightness\n
+													 0..255 of screen 0/1\n
+													 (channel), mapped by\n
+													 #XC02_BLK_BR_LUT\n*/
+#define XC02_ABR_STOP			 M_DEV_OF+0x33   /**<  S: Stop auto brightness\n
+													 controller\n*/
+#define XC02_ABR_AMBIENT		 M_DEV_OF+0x34   /**<G  : filtered photo sensor\n
+													 value of the auto\n
+													 brightness controller\n*/
+#define XC02_DERATE_STOP		 M_DEV_OF+0x35   /**<  S: Stop thermal derating,\n
+													 restore brightness\n*/
+#define XC02_DERATE_CAP			 M_DEV_OF+0x36   /**<G  : current derating cap,\n
+													 logical level, 255: none\n*/
+#define XC02_TRACE_PERIOD		 M_DEV_OF+0x37   /**<G,S: firmware state tracer\n
+													 sample period [msec],\n
+													 min. 10, 0: off\n*/
+#define XC02_WDOG_LEASE			 M_DEV_OF+0x38   /**<G,S: watchdog heartbeat\n
+													 lease [msec], driver\n
+													 triggers, WDOG_TRIG renews\n
+													 the lease, 0: off\n*/
+#define XC02_WDOG_LEASE_LEFT	 M_DEV_OF+0x39   /**<G  : remaining lease [msec],\n
+													 0: lapsed or inactive\n*/
+#define XC02_WDOG_COALESCE		 M_DEV_OF+0x3a   /**<G,S: watchdog trigger\n
+													 coalescing, skip triggers\n
+													 younger than WDOG_TIME/n,\n
+													 n: 4..100, 0: off\n*/
+#define XC02_WDOG_UNREGISTER	 M_DEV_OF+0x3b   /**<  S: remove watchdog client,\n
+													 value: client id\n*/
+#define XC02_WDOG_CHECKIN		 M_DEV_OF+0x3c   /**<  S: watchdog client\n
+													 heartbeat, value: client id\n*/
+#define XC02_BR_EFFECTIVE		 M_DEV_OF+0x3d   /**<G  : brightness 0..200 of\n
+													 screen 0/1 (channel) as\n
+													 written to the PIC, i.e.\n
+													 including derating cap\n*/
 
 
 
@@ -130,6 +520,151 @@ typedef struct {
 													 see #XC02_BLK_DOWN_SIG
 													 structure. Default: \n
 													 0 (no signal)\n */
+#define XC02_BLK_SNAPSHOT_GET	M_DEV_BLK_OF+0x01 /**<G : Get all volatile\n
+													 telemetry at once. Values:\n
+													 see #XC02_BLK_SNAPSHOT
+													 structure\n */
+#define XC02_BLK_CONFIG_GET		M_DEV_BLK_OF+0x02 /**<G : Get all configuration\n
+													 registers at once. Values:\n
+													 see #XC02_BLK_CONFIG
+													 structure\n */
+#define XC02_BLK_BATCH_SET		M_DEV_BLK_OF+0x03 /**< S: Validate and apply a\n
+													 list of setstats at once.\n
+													 Values: see #XC02_BLK_BATCH
+													 structure\n */
+#define XC02_BLK_STATS_GET		M_DEV_BLK_OF+0x04 /**<G : Get telemetry\n
+													 statistics, fed by the\n
+													 sampler. Values: see\n
+													 #XC02_BLK_STATS structure\n */
+#define XC02_BLK_THRESH_SET		M_DEV_BLK_OF+0x05 /**< S: Install signal for \n
+													 temp/volt warning threshold\n
+													 crossings. Values: see\n
+													 #XC02_BLK_THRESH structure\n */
+#define XC02_BLK_IN_SIG_SET		M_DEV_BLK_OF+0x06 /**< S: Install signal for \n
+													 #XC02_IN changes. Values:\n
+													 see #XC02_BLK_IN_SIG\n
+													 structure\n */
+#define XC02_BLK_IN_EVT_GET		M_DEV_BLK_OF+0x07 /**<G : Get and remove queued\n
+													 input transitions. Values:\n
+													 see #XC02_BLK_IN_EVT\n
+													 structure\n */
+#define XC02_BLK_SUBSCRIBE		M_DEV_BLK_OF+0x08 /**< S: Add subscriber with\n
+													 own signal for driver\n
+													 events. Values: see\n
+													 #XC02_BLK_SUBSCR structure\n */
+#define XC02_BLK_LOG_GET		M_DEV_BLK_OF+0x09 /**<G : Read event log from a\n
+													 sequence number on. Values:\n
+													 see #XC02_BLK_LOG\n
+													 structure\n */
+#define XC02_BLK_FADE_SET		M_DEV_BLK_OF+0x0a /**< S: Fade brightness to a\n
+													 target level. Values: see\n
+													 #XC02_BLK_FADE structure\n */
+#define XC02_BLK_BR_LUT_SET		M_DEV_BLK_OF+0x0b /**< S: Load brightness lookup\n
+													 table. Values: see\n
+													 #XC02_BLK_BR_LUT structure.\n
+													 Default: linear, 255 is\n
+													 brightest\n */
+#define XC02_BLK_ABR_SET		M_DEV_BLK_OF+0x0c /**< S: Start auto brightness\n
+													 controller. Values: see\n
+													 #XC02_BLK_ABR structure\n */
+#define XC02_BLK_DERATE_SET		M_DEV_BLK_OF+0x0d /**< S: Start thermal brightness\n
+													 derating. Values: see\n
+													 #XC02_BLK_DERATE structure\n */
+#define XC02_BLK_ENERGY_GET		M_DEV_BLK_OF+0x0e /**<G : SC21 only: backlight\n
+													 energy, fed by the sampler.\n
+													 Values: see\n
+													 #XC02_BLK_ENERGY structure\n */
+#define XC02_BLK_TRACE_GET		M_DEV_BLK_OF+0x0f /**<G : Get and remove queued\n
+													 firmware state transitions.\n
+													 Values: see\n
+													 #XC02_BLK_TRACE structure\n */
+#define XC02_BLK_TRACE_STATS_GET M_DEV_BLK_OF+0x10 /**<G : Get dwell time\n
+													 statistics per firmware\n
+													 state. Values: see\n
+													 #XC02_BLK_TRACE_STATS\n
+													 structure\n */
+#define XC02_BLK_WDOG_STATS_GET	M_DEV_BLK_OF+0x11 /**<G : Get watchdog trigger\n
+													 counters. Values: see\n
+													 #XC02_BLK_WDOG_STATS\n
+													 structure\n */
+#define XC02_BLK_WDOG_REGISTER	M_DEV_BLK_OF+0x12 /**< S: Register a watchdog\n
+													 client. Values: see\n
+													 #XC02_BLK_WDOG_CLIENT\n
+													 structure\n */
+#define XC02_BLK_WDOG_STARVED_GET M_DEV_BLK_OF+0x13 /**<G : Get the client that\n
+													 starved the watchdog.\n
+													 Values: see\n
+													 #XC02_BLK_WDOG_STARVED\n
+													 structure\n */
+/**@}*/
+
+/** \name Events of #XC02_BLK_SUBSCR
+ *  \anchor XC02_EVT_xxx
+ */
+/**@{*/
+#define XC02_EVT_DOWN			0x01	/**< shutdown event */
+#define XC02_EVT_THRESH			0x02	/**< warning threshold state change */
+#define XC02_EVT_IN				0x04	/**< input change */
+#define XC02_EVT_FADE			0x08	/**< brightness fade completed */
+#define XC02_EVT_ALL			(XC02_EVT_DOWN | XC02_EVT_THRESH | \
+								 XC02_EVT_IN | XC02_EVT_FADE) /**< all events */
+/**@}*/
+
+/** \name Event types of #XC02_LOG_ENTRY and their data
+ *  \anchor XC02_LOG_xxx
+ */
+/**@{*/
+#define XC02_LOG_DOWN			1	/**< shutdown event, data: #XC02_DOWN_EVT\n
+										 status flags */
+#define XC02_LOG_IN				2	/**< input change, data: old<<8 | new */
+#define XC02_LOG_THRESH			3	/**< threshold state change,\n
+										 data: old<<8 | new \ref XC02_THR_xxx */
+#define XC02_LOG_WDOG_START		4	/**< watchdog started */
+#define XC02_LOG_WDOG_STOP		5	/**< watchdog stopped */
+#define XC02_LOG_WDOG_MISS		6	/**< missed watchdog trigger,\n
+										 data: old<<8 | new #XC02_WDOG_ERR */
+#define XC02_LOG_SMB_ERR		7	/**< first SMBus error after success,\n
+										 data: register<<16 | error code */
+#define XC02_LOG_FW_STATE		8	/**< firmware state change,\n
+										 data: old<<8 | new XC02C_SM_STATES */
+#define XC02_LOG_DERATE			9	/**< derating cap change,\n
+										 data: old<<8 | new level */
+#define XC02_LOG_WDOG_LAPSE		10	/**< watchdog lease lapsed,\n
+										 data: lease [ms] */
+#define XC02_LOG_WDOG_STARVE	11	/**< watchdog client missed its\n
+										 deadline, data: client id */
+/**@}*/
+
+/** \name Channels and state flags of the warning thresholds
+ *  \anchor XC02_THR_xxx
+ */
+/**@{*/
+#define XC02_THR_TEMP			0x01	/**< mask: check temperature */
+#define XC02_THR_VOLT			0x02	/**< mask: check voltage */
+#define XC02_THR_TEMP_HIGH		0x01	/**< state: temp above high limit */
+#define XC02_THR_TEMP_LOW		0x02	/**< state: temp below low limit */
+#define XC02_THR_VOLT_HIGH		0x04	/**< state: volt above high limit */
+#define XC02_THR_VOLT_LOW		0x08	/**< state: volt below low limit */
+/**@}*/
+
+/** \name Validity flags for #XC02_BLK_SNAPSHOT and #XC02_SMP_REC
+ *  \anchor XC02_SNAP_xxx
+ */
+/**@{*/
+#define XC02_SNAPSHOT_VERSION	1		/**< current snapshot struct version */
+#define XC02_CONFIG_VERSION		1		/**< current config struct version */
+#define XC02_SNAP_TEMP			0x0001	/**< temp valid */
+#define XC02_SNAP_VOLT			0x0002	/**< volt valid */
+#define XC02_SNAP_IN			0x0004	/**< in valid */
+#define XC02_SNAP_STATUS		0x0008	/**< status valid */
+#define XC02_SNAP_SW_DISP		0x0010	/**< swDisp valid */
+#define XC02_SNAP_BRIGHT		0x0020	/**< bright valid */
+#define XC02_SNAP_BRIGHT2		0x0040	/**< bright2 valid */
+#define XC02_SNAP_BR_RAW		0x0080	/**< brRaw valid */
+#define XC02_SNAP_BL_CURR		0x0100	/**< blCurr valid */
+#define XC02_SMP_MASK_ALL		(XC02_SNAP_TEMP | XC02_SNAP_VOLT | \
+								 XC02_SNAP_IN | XC02_SNAP_BL_CURR | \
+								 XC02_SNAP_BR_RAW) /**< all sampler channels */
 /**@}*/
 
 #ifndef  XC02_VARIANT
@@ -150,6 +685,7 @@ typedef struct {
 #define  XC02_TEMP2ADC(T)    ((((10*(T))+500)*255)/ADC_REF_3V) /**<  convert C to raw ADC value, see LM50 datasheet */
 #define  XC02_ADC2VOLT(ADC)  (ADC_REF_3V*(ADC)/255) /**<  convert ADC value to Voltage */
 #define  SC21_ADC2POWER(ADC) ((72*(ADC))/255) /**<  convert ADC value to 12V power */
+#define  SC21_ADC2MW(ADC)    ((72000*(ADC))/255) /**<  convert ADC value to 12V power [mW] */
 
 /**@}*/
 